@@ -6,6 +6,19 @@
 #include "Engine/LocalPlayer.h"
 #include "GameFramework/Controller.h"
 
+ACookingWithGasCharacter::ACookingWithGasCharacter()
+{
+	// Create a camera boom (pulls in towards the player if there is a collision)
+	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
+	CameraBoom->SetupAttachment(RootComponent);
+	CameraBoom->TargetArmLength = 400.0f; // The camera follows at this distance behind the character	
+	CameraBoom->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+
+	// Create a follow camera
+	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
+	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
+	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+}
 
 void ACookingWithGasCharacter::BeginPlay()
 {
@@ -23,6 +36,16 @@ void ACookingWithGasCharacter::BeginPlay()
 	
 }
 
+void ACookingWithGasCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	// Other players' characters never look through their camera, so their boom skips its probes
+	const bool bIsLocalView = IsLocallyControlled();
+	CameraBoom->SetComponentTickEnabled(bIsLocalView);
+	FollowCamera->SetComponentTickEnabled(bIsLocalView);
+}
+
 void ACookingWithGasCharacter::OnRep_PlayerState()
 {
 	Super::OnRep_PlayerState();
@@ -57,8 +80,23 @@ void ACookingWithGasCharacter::SetupPlayerInputComponent(UInputComponent* Player
 			ETriggerEvent::Triggered, this, &ACookingWithGasCharacter::Look);
 
 		// Ability Actions
+		// Only the edges are bound; holding the button does not resend the press every frame
 		EnhancedInputComponent->BindAction(FireAbilityAction,
-			ETriggerEvent::Triggered, this, &ACookingWithGasCharacter::OnFireAbility);
+			ETriggerEvent::Started, this, &ACookingWithGasCharacter::OnFireAbility);
+		EnhancedInputComponent->BindAction(FireAbilityAction,
+			ETriggerEvent::Completed, this, &ACookingWithGasCharacter::OnFireAbilityReleased);
+		EnhancedInputComponent->BindAction(FireAbilityAction,
+			ETriggerEvent::Canceled, this, &ACookingWithGasCharacter::OnFireAbilityReleased);
+
+		for (const TPair<UInputAction*, FGameplayTag>& TagAction : AbilityInputTagActions)
+		{
+			EnhancedInputComponent->BindAction(TagAction.Key,
+				ETriggerEvent::Started, this, &ACookingWithGasCharacter::OnAbilityInputTagPressed, TagAction.Value);
+			EnhancedInputComponent->BindAction(TagAction.Key,
+				ETriggerEvent::Completed, this, &ACookingWithGasCharacter::OnAbilityInputTagReleased, TagAction.Value);
+			EnhancedInputComponent->BindAction(TagAction.Key,
+				ETriggerEvent::Canceled, this, &ACookingWithGasCharacter::OnAbilityInputTagReleased, TagAction.Value);
+		}
 	}
 	
 	// Call the function that handles ability system bindings
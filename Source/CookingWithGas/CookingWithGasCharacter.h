@@ -4,7 +4,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Camera/CameraComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "GameFramework/SpringArmComponent.h"
 #include "GGCharacterBase.h"
 
 #include "CookingWithGasCharacter.generated.h"
@@ -16,8 +18,8 @@ class ACookingWithGasCharacter : public AGGCharacterBase
 	GENERATED_BODY()
 public:
 	
-	ACookingWithGasCharacter() {};
-	
+	ACookingWithGasCharacter();
+
 	/** MappingContext */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputMappingContext* DefaultMappingContext = nullptr;
@@ -38,12 +40,19 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* FireAbilityAction = nullptr;
 
+	/** Input Actions for abilities bound through UGGGameplayAbility::InputTag */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true", Categories = "Input"))
+	TMap<UInputAction*, FGameplayTag> AbilityInputTagActions;
+
 protected:
 
 	virtual void BeginPlay() override;
 	
 	virtual void OnRep_PlayerState() override;
 
+	// Only the locally controlled character keeps its camera ticking
+	virtual void NotifyControllerChanged() override;
+
 	// From APawn.h
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
 
@@ -55,6 +64,5 @@ protected:
 
 	// Binds inputs specifically set for abilities & effects
 	virtual void BindInput();
-	
 };
 
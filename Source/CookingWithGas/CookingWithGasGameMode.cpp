@@ -2,14 +2,29 @@
 
 #include "CookingWithGasGameMode.h"
 #include "CookingWithGasCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "GGPreloadSubsystem.h"
 
 ACookingWithGasGameMode::ACookingWithGasGameMode()
 {
 	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter"));
-	if (PlayerPawnBPClass.Class != nullptr)
+	PlayerPawnClass = TSoftClassPtr<APawn>(FSoftObjectPath(
+		TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter.BP_ThirdPersonCharacter_C")));
+}
+
+void ACookingWithGasGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	TArray<TSoftClassPtr<APawn>> PawnClasses = PreloadPawnClasses;
+	PawnClasses.Add(PlayerPawnClass);
+	UGGPreloadSubsystem::PreloadPawnClasses(this, PawnClasses);
+}
+
+UClass* ACookingWithGasGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	if (UClass* PawnClass = UGGPreloadSubsystem::GetOrLoadClass(this, PlayerPawnClass.ToSoftObjectPath()))
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
+		return PawnClass;
 	}
+	return Super::GetDefaultPawnClassForController_Implementation(InController);
 }
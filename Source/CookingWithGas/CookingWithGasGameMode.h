@@ -13,6 +13,19 @@ class ACookingWithGasGameMode : public AGameModeBase
 
 public:
 	ACookingWithGasGameMode();
+
+	// Starts preloading the player pawn and PreloadPawnClasses while the map loads
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+
+	// Pawn spawned for players; a soft reference so the game mode does not load it on construction
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Classes)
+	TSoftClassPtr<APawn> PlayerPawnClass;
+
+	// Pawns spawned during play, such as enemies, loaded with their abilities and effects during map load
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Classes)
+	TArray<TSoftClassPtr<APawn>> PreloadPawnClasses;
 };
 
 
@@ -0,0 +1,487 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGAbilitySystemComponent.h"
+#include "GGAttributeSet.h"
+#include "GGGameplayAbility.h"
+#include "GGMemoryReport.h"
+#include "HAL/IConsoleManager.h"
+
+static bool bAbilitySystemDynamicTick = true;
+static FAutoConsoleVariableRef CVarAbilitySystemDynamicTick(
+	TEXT("gg.AbilitySystem.DynamicTick"), bAbilitySystemDynamicTick,
+	TEXT("If true, ability system components only tick while they have ticking tasks or montages to replicate. ")
+	TEXT("Read when a component re-evaluates its tick."));
+
+UGGAbilitySystemComponent::UGGAbilitySystemComponent()
+{
+	// The engine starts every ability system ticking; UpdateShouldTick turns it on when needed
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+/**
+ *  Same as the engine rules: ticking ability tasks, a montage whose replicated info has to be
+ *  updated on the server, or a tickable attribute set. Re-evaluated by UpdateShouldTick when
+ *  ticking tasks start and end, when a montage starts, and every tick while ticking.
+ * @return True if the component has to tick
+ */
+bool UGGAbilitySystemComponent::GetShouldTick() const
+{
+	return !bAbilitySystemDynamicTick || Super::GetShouldTick();
+}
+
+void UGGAbilitySystemComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Tasks or montages started before play began need the tick from the start
+	UpdateShouldTick();
+}
+
+float UGGAbilitySystemComponent::PlayMontage(UGameplayAbility* AnimatingAbility,
+	FGameplayAbilityActivationInfo ActivationInfo, UAnimMontage* Montage, float InPlayRate,
+	FName StartSectionName, float StartTimeSeconds)
+{
+	const float Duration = Super::PlayMontage(AnimatingAbility, ActivationInfo, Montage, InPlayRate,
+		StartSectionName, StartTimeSeconds);
+	UpdateShouldTick();
+	return Duration;
+}
+
+/**
+ *  Same as the engine implementation, except only the abilities bound to the input are
+ *  visited, and abilities that ask for batched server RPCs are activated through
+ *  BatchRPCTryActivateAbility.
+ * @param InputID The EAbilityInputID that was pressed, as an integer
+ */
+void UGGAbilitySystemComponent::AbilityLocalInputPressed(int32 InputID)
+{
+	// Consume the input if this InputID is overloaded with GenericConfirm/Cancel and the callback is bound
+	if (IsGenericConfirmInputBound(InputID))
+	{
+		LocalInputConfirm();
+		return;
+	}
+
+	if (IsGenericCancelInputBound(InputID))
+	{
+		LocalInputCancel();
+		return;
+	}
+
+	ABILITYLIST_SCOPE_LOCK();
+	if (const FAbilityHandleList* Handles = InputIDToAbilityHandles.Find(InputID))
+	{
+		for (const FGameplayAbilitySpecHandle& Handle : *Handles)
+		{
+			if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleFast(Handle))
+			{
+				PressAbilitySpecInput(*Spec);
+			}
+		}
+	}
+}
+
+/**
+ *  Same as the engine implementation, but only visits the abilities bound to the input.
+ * @param InputID The EAbilityInputID that was released, as an integer
+ */
+void UGGAbilitySystemComponent::AbilityLocalInputReleased(int32 InputID)
+{
+	ABILITYLIST_SCOPE_LOCK();
+	if (const FAbilityHandleList* Handles = InputIDToAbilityHandles.Find(InputID))
+	{
+		for (const FGameplayAbilitySpecHandle& Handle : *Handles)
+		{
+			if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleFast(Handle))
+			{
+				ReleaseAbilitySpecInput(*Spec);
+			}
+		}
+	}
+}
+
+void UGGAbilitySystemComponent::AbilityInputTagPressed(const FGameplayTag& InputTag)
+{
+	ABILITYLIST_SCOPE_LOCK();
+	if (const FAbilityHandleList* Handles = InputTagToAbilityHandles.Find(InputTag))
+	{
+		for (const FGameplayAbilitySpecHandle& Handle : *Handles)
+		{
+			if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleFast(Handle))
+			{
+				PressAbilitySpecInput(*Spec);
+			}
+		}
+	}
+}
+
+void UGGAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& InputTag)
+{
+	ABILITYLIST_SCOPE_LOCK();
+	if (const FAbilityHandleList* Handles = InputTagToAbilityHandles.Find(InputTag))
+	{
+		for (const FGameplayAbilitySpecHandle& Handle : *Handles)
+		{
+			if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleFast(Handle))
+			{
+				ReleaseAbilitySpecInput(*Spec);
+			}
+		}
+	}
+}
+
+void UGGAbilitySystemComponent::PressAbilitySpecInput(FGameplayAbilitySpec& Spec)
+{
+	if (!Spec.Ability)
+	{
+		return;
+	}
+
+	Spec.InputPressed = true;
+	if (Spec.IsActive())
+	{
+		if (Spec.Ability->bReplicateInputDirectly && !IsOwnerActorAuthoritative())
+		{
+			ServerSetInputPressed(Spec.Handle);
+		}
+
+		AbilitySpecInputPressed(Spec);
+
+		// Not replicated here; listeners may replicate the InputPressed event themselves
+		InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputPressed,
+			Spec.Handle, Spec.ActivationInfo.GetActivationPredictionKey());
+	}
+	else
+	{
+		const UGGGameplayAbility* Ability = Cast<UGGGameplayAbility>(Spec.Ability);
+		if (Ability && Ability->bBatchServerRPCs)
+		{
+			BatchRPCTryActivateAbility(Spec.Handle);
+		}
+		else
+		{
+			TryActivateAbility(Spec.Handle);
+		}
+	}
+}
+
+void UGGAbilitySystemComponent::ReleaseAbilitySpecInput(FGameplayAbilitySpec& Spec)
+{
+	Spec.InputPressed = false;
+	if (Spec.Ability && Spec.IsActive())
+	{
+		if (Spec.Ability->bReplicateInputDirectly && !IsOwnerActorAuthoritative())
+		{
+			ServerSetInputReleased(Spec.Handle);
+		}
+
+		AbilitySpecInputReleased(Spec);
+
+		InvokeReplicatedEvent(EAbilityGenericReplicatedEvent::InputReleased,
+			Spec.Handle, Spec.ActivationInfo.GetActivationPredictionKey());
+	}
+}
+
+TConstArrayView<FGameplayAbilitySpecHandle> UGGAbilitySystemComponent::GetAbilityHandlesForInput(int32 InputID) const
+{
+	const FAbilityHandleList* Handles = InputIDToAbilityHandles.Find(InputID);
+	return Handles ? TConstArrayView<FGameplayAbilitySpecHandle>(*Handles) : TConstArrayView<FGameplayAbilitySpecHandle>();
+}
+
+FGameplayAbilitySpec* UGGAbilitySystemComponent::FindAbilitySpecFromHandleFast(FGameplayAbilitySpecHandle Handle)
+{
+	return const_cast<FGameplayAbilitySpec*>(
+		static_cast<const UGGAbilitySystemComponent*>(this)->FindAbilitySpecFromHandleFast(Handle));
+}
+
+/**
+ *  Looks the spec up through its cached index. Specs move around when others are removed,
+ *  so a stale index falls back to a scan once and caches the new position.
+ * @param Handle The handle of the spec to find
+ * @return The spec, or nullptr if it is not granted
+ */
+const FGameplayAbilitySpec* UGGAbilitySystemComponent::FindAbilitySpecFromHandleFast(FGameplayAbilitySpecHandle Handle) const
+{
+	const TArray<FGameplayAbilitySpec>& Specs = ActivatableAbilities.Items;
+	if (const int32* CachedIndex = AbilitySpecIndices.Find(Handle))
+	{
+		if (Specs.IsValidIndex(*CachedIndex) && Specs[*CachedIndex].Handle == Handle)
+		{
+			return &Specs[*CachedIndex];
+		}
+	}
+
+	const int32 Index = Specs.IndexOfByPredicate([Handle](const FGameplayAbilitySpec& Spec)
+	{
+		return Spec.Handle == Handle;
+	});
+	if (Index == INDEX_NONE)
+	{
+		AbilitySpecIndices.Remove(Handle);
+		return nullptr;
+	}
+
+	AbilitySpecIndices.Add(Handle, Index);
+	return &Specs[Index];
+}
+
+void UGGAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	Super::OnGiveAbility(AbilitySpec);
+
+	InputIDToAbilityHandles.FindOrAdd(AbilitySpec.InputID).AddUnique(AbilitySpec.Handle);
+
+	if (const UGGGameplayAbility* Ability = Cast<UGGGameplayAbility>(AbilitySpec.Ability))
+	{
+		if (Ability->InputTag.IsValid())
+		{
+			InputTagToAbilityHandles.FindOrAdd(Ability->InputTag).AddUnique(AbilitySpec.Handle);
+		}
+	}
+
+	// The spec is already part of the list when this is called
+	const int32 Index = static_cast<int32>(&AbilitySpec - ActivatableAbilities.Items.GetData());
+	if (ActivatableAbilities.Items.IsValidIndex(Index))
+	{
+		AbilitySpecIndices.Add(AbilitySpec.Handle, Index);
+	}
+}
+
+void UGGAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	if (FAbilityHandleList* Handles = InputIDToAbilityHandles.Find(AbilitySpec.InputID))
+	{
+		Handles->RemoveSingleSwap(AbilitySpec.Handle);
+		if (Handles->Num() == 0)
+		{
+			InputIDToAbilityHandles.Remove(AbilitySpec.InputID);
+		}
+	}
+
+	if (const UGGGameplayAbility* Ability = Cast<UGGGameplayAbility>(AbilitySpec.Ability))
+	{
+		if (FAbilityHandleList* Handles = InputTagToAbilityHandles.Find(Ability->InputTag))
+		{
+			Handles->RemoveSingleSwap(AbilitySpec.Handle);
+			if (Handles->Num() == 0)
+			{
+				InputTagToAbilityHandles.Remove(Ability->InputTag);
+			}
+		}
+	}
+
+	AbilitySpecIndices.Remove(AbilitySpec.Handle);
+
+	Super::OnRemoveAbility(AbilitySpec);
+}
+
+/**
+ *  Activates an ability inside a FScopedServerAbilityRPCBatcher, so the activation and any
+ *  target data or end ability calls made during activation reach the server as one RPC.
+ * @param AbilityHandle The spec handle of the ability to activate
+ * @param bEndAbilityImmediately True to end the ability before the batch is sent
+ * @return True if the ability was activated
+ */
+bool UGGAbilitySystemComponent::BatchRPCTryActivateAbility(FGameplayAbilitySpecHandle AbilityHandle,
+	bool bEndAbilityImmediately)
+{
+	if (!AbilityHandle.IsValid())
+	{
+		return false;
+	}
+
+	FScopedServerAbilityRPCBatcher AbilityRPCBatcher(this, AbilityHandle);
+	const bool bActivated = TryActivateAbility(AbilityHandle, true);
+
+	if (bActivated && bEndAbilityImmediately)
+	{
+		if (FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandleFast(AbilityHandle))
+		{
+			if (UGameplayAbility* Instance = Spec->GetPrimaryInstance())
+			{
+				Instance->K2_EndAbility();
+			}
+		}
+	}
+
+	return bActivated;
+}
+
+/**
+ *  Returns the offense attributes of this component for one damage type against one target
+ *  tag set. The first request evaluates the attribute aggregators with the owned tags plus the
+ *  damage type as source tags and the target tags, so conditional buffs (such as +damage for
+ *  fire only, or against burning targets) are folded in; later requests read the cached result.
+ * @param DamageType The Damage.Type tag of the hit, or an empty tag
+ * @param TargetTags The tags of the target, or null for none
+ * @return The snapshot; valid until the next call
+ */
+const FGGOffenseSnapshot& UGGAbilitySystemComponent::GetOffenseSnapshot(const FGameplayTag& DamageType,
+	const FGameplayTagContainer* TargetTags)
+{
+	static const FGameplayTagContainer NoTags;
+	const FGameplayTagContainer& Targets = TargetTags ? *TargetTags : NoTags;
+	for (const FOffenseSnapshotEntry& Entry : OffenseSnapshots)
+	{
+		if (Entry.DamageType == DamageType && Entry.TargetTags == Targets)
+		{
+			return Entry.Snapshot;
+		}
+	}
+
+	if (!GetSet<UGGAttributeSet>())
+	{
+		static const FGGOffenseSnapshot DefaultSnapshot;
+		return DefaultSnapshot;
+	}
+
+	// Any change to the aggregators or owned tags from now on drops the cache
+	const FGameplayAttribute OffenseAttributes[] =
+	{
+		UGGAttributeSet::GetCriticalChanceAttribute(),
+		UGGAttributeSet::GetCriticalMultiplierAttribute(),
+		UGGAttributeSet::GetLuckyChanceAttribute(),
+		UGGAttributeSet::GetDamageAddAttribute(),
+		UGGAttributeSet::GetDamageMultiAttribute(),
+	};
+	if (!bOffenseSnapshotsBound)
+	{
+		bOffenseSnapshotsBound = true;
+		for (const FGameplayAttribute& Attribute : OffenseAttributes)
+		{
+			if (FAggregator* Aggregator = ActiveGameplayEffects.FindOrCreateAttributeAggregator(Attribute).Get())
+			{
+				Aggregator->OnDirty.AddUObject(this, &UGGAbilitySystemComponent::OnOffenseAggregatorDirty);
+			}
+		}
+		RegisterGenericGameplayTagEvent().AddUObject(this, &UGGAbilitySystemComponent::OnOffenseTagChanged);
+	}
+
+	// Bounded so targets with ever changing tags cannot grow the cache
+	static constexpr int32 MaxOffenseSnapshots = 16;
+	if (OffenseSnapshots.Num() >= MaxOffenseSnapshots)
+	{
+		OffenseSnapshots.Reset();
+	}
+
+	FOffenseSnapshotEntry& Entry = OffenseSnapshots.AddDefaulted_GetRef();
+	Entry.DamageType = DamageType;
+	Entry.TargetTags = Targets;
+	FGGOffenseSnapshot& Snapshot = Entry.Snapshot;
+
+	FGameplayTagContainer SourceTags;
+	GetOwnedGameplayTags(SourceTags);
+	if (DamageType.IsValid())
+	{
+		SourceTags.AddTag(DamageType);
+	}
+
+	FAggregatorEvaluateParameters EvaluationParameters;
+	EvaluationParameters.SourceTags = &SourceTags;
+	EvaluationParameters.TargetTags = &Targets;
+
+	float Values[UE_ARRAY_COUNT(OffenseAttributes)];
+	for (int32 i = 0; i < UE_ARRAY_COUNT(OffenseAttributes); ++i)
+	{
+		const FAggregator* Aggregator = ActiveGameplayEffects.FindOrCreateAttributeAggregator(OffenseAttributes[i]).Get();
+		Values[i] = Aggregator
+			? Aggregator->Evaluate(EvaluationParameters)
+			: GetNumericAttribute(OffenseAttributes[i]);
+	}
+
+	Snapshot.CriticalChance		= Values[0];
+	Snapshot.CriticalMultiplier	= Values[1];
+	Snapshot.LuckyChance		= Values[2];
+	Snapshot.DamageAdd			= Values[3];
+	Snapshot.DamageMulti		= Values[4];
+	return Snapshot;
+}
+
+void UGGAbilitySystemComponent::InvalidateOffenseSnapshots()
+{
+	OffenseSnapshots.Reset();
+}
+
+void UGGAbilitySystemComponent::OnOffenseAggregatorDirty(FAggregator* Aggregator)
+{
+	InvalidateOffenseSnapshots();
+}
+
+void UGGAbilitySystemComponent::OnOffenseTagChanged(const FGameplayTag Tag, int32 NewCount)
+{
+	InvalidateOffenseSnapshots();
+}
+
+/**
+ *  Measures what this component owns: its own object and input tables, each spawned attribute
+ *  set, the granted specs with their ability instances, and the active effects with their
+ *  contexts. Effect definitions and ability CDOs are shared and not counted.
+ * @param Footprint The footprint of the owning actor, added to
+ * @param CountedContexts Contexts already counted for another effect or actor
+ */
+void UGGAbilitySystemComponent::AccumulateMemoryFootprint(FGGActorMemoryFootprint& Footprint,
+	TSet<const FGameplayEffectContext*>& CountedContexts) const
+{
+	uint64 InputTableBytes = InputIDToAbilityHandles.GetAllocatedSize()
+		+ InputTagToAbilityHandles.GetAllocatedSize()
+		+ AbilitySpecIndices.GetAllocatedSize();
+	for (const TPair<int32, FAbilityHandleList>& Pair : InputIDToAbilityHandles)
+	{
+		InputTableBytes += Pair.Value.GetAllocatedSize();
+	}
+	for (const TPair<FGameplayTag, FAbilityHandleList>& Pair : InputTagToAbilityHandles)
+	{
+		InputTableBytes += Pair.Value.GetAllocatedSize();
+	}
+	Footprint[EGGMemoryCategory::AbilitySystem] += GetClass()->GetStructureSize() + InputTableBytes;
+
+	for (const UAttributeSet* AttributeSet : GetSpawnedAttributes())
+	{
+		if (AttributeSet)
+		{
+			Footprint[EGGMemoryCategory::AttributeSets] += AttributeSet->GetClass()->GetStructureSize();
+		}
+	}
+
+	Footprint[EGGMemoryCategory::AbilitySpecs] += ActivatableAbilities.Items.GetAllocatedSize();
+	for (const FGameplayAbilitySpec& Spec : ActivatableAbilities.Items)
+	{
+		++Footprint.NumAbilitySpecs;
+		Footprint[EGGMemoryCategory::AbilitySpecs] += Spec.ReplicatedInstances.GetAllocatedSize()
+			+ Spec.NonReplicatedInstances.GetAllocatedSize()
+			+ Spec.DynamicAbilityTags.GetGameplayTagArray().GetAllocatedSize();
+		for (const UGameplayAbility* Instance : Spec.GetAbilityInstances())
+		{
+			if (Instance)
+			{
+				Footprint[EGGMemoryCategory::AbilitySpecs] += Instance->GetClass()->GetStructureSize();
+			}
+		}
+	}
+
+	for (const FActiveGameplayEffect& ActiveEffect : &ActiveGameplayEffects)
+	{
+		++Footprint.NumActiveEffects;
+		const FGameplayEffectSpec& Spec = ActiveEffect.Spec;
+		Footprint[EGGMemoryCategory::ActiveEffects] += sizeof(FActiveGameplayEffect)
+			+ Spec.Modifiers.GetAllocatedSize()
+			+ Spec.ModifiedAttributes.GetAllocatedSize()
+			+ Spec.SetByCallerNameMagnitudes.GetAllocatedSize()
+			+ Spec.SetByCallerTagMagnitudes.GetAllocatedSize();
+
+		const FGameplayEffectContext* Context = Spec.GetContext().Get();
+		bool bAlreadyCounted = true;
+		if (Context)
+		{
+			CountedContexts.Add(Context, &bAlreadyCounted);
+		}
+		if (!bAlreadyCounted)
+		{
+			++Footprint.NumEffectContexts;
+			Footprint[EGGMemoryCategory::EffectContexts] += Context->GetScriptStruct()->GetStructureSize()
+				+ (Context->GetHitResult() ? sizeof(FHitResult) : 0)
+				+ Context->GetActors().GetAllocatedSize();
+		}
+	}
+}
@@ -4,6 +4,7 @@
 #include "../Public/GGAttributeSet.h"
 #include "GameplayEffectExtension.h"	// For:		const FGameplayEffectModCallbackData& Data
 #include "GGGameplayEffectContext.h"
+#include "GGHitFeedbackSubsystem.h"
 #include "Logging/StructuredLog.h"
 #include "Net/UnrealNetwork.h"			// Replication
 
@@ -18,69 +19,77 @@ UGGAttributeSet::UGGAttributeSet()
 	
 }
 
-void UGGAttributeSet::OnRep_Health(const FGameplayAttributeData& OldHealthData)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, Health, OldHealthData);
-}
-
-void UGGAttributeSet::OnRep_HealthMax(const FGameplayAttributeData& OldHealthMaxData)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, HealthMax, OldHealthMaxData);
-}
-
-void UGGAttributeSet::OnRep_Armor(const FGameplayAttributeData& OldArmorData)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, Armor, OldArmorData);
-}
-
-void UGGAttributeSet::OnRep_ArmorMax(const FGameplayAttributeData& OldArmorMaxData)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, ArmorMax, OldArmorMaxData);
-}
-
-void UGGAttributeSet::OnRep_InDamage(const FGameplayAttributeData& OldInDamage)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, InDamage, OldInDamage);
-}
-
-void UGGAttributeSet::OnRep_CriticalChance(const FGameplayAttributeData& OldCriticalChance)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, CriticalChance, OldCriticalChance);
-}
-
-void UGGAttributeSet::OnRep_CriticalMultiplier(const FGameplayAttributeData& OldCriticalMultiplier)
+// Rep-notifies for every attribute in GG_ATTRIBUTE_LIST marked as replicated
+#define GG_ATTRIBUTE_REPNOTIFY_true(Name) \
+	void UGGAttributeSet::OnRep_##Name(const FGameplayAttributeData& Old##Name) \
+	{ \
+		GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, Name, Old##Name); \
+	}
+#define GG_ATTRIBUTE_REPNOTIFY_false(Name)
+#define GG_ATTRIBUTE_REPNOTIFY(Name, bReplicated, ClampRule) GG_ATTRIBUTE_REPNOTIFY_##bReplicated(Name)
+GG_ATTRIBUTE_LIST(GG_ATTRIBUTE_REPNOTIFY)
+#undef GG_ATTRIBUTE_REPNOTIFY
+#undef GG_ATTRIBUTE_REPNOTIFY_false
+#undef GG_ATTRIBUTE_REPNOTIFY_true
+
+namespace GGAttributeTable
 {
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, CriticalMultiplier, OldCriticalMultiplier);
-}
+	// Clamp rule of every attribute, indexed by EGGAttribute
+	static const FGGAttributeClampRule ClampRules[] =
+	{
+#define GG_ATTRIBUTE_CLAMP_RULE(Name, bReplicated, ClampRule) ClampRule,
+		GG_ATTRIBUTE_LIST(GG_ATTRIBUTE_CLAMP_RULE)
+#undef GG_ATTRIBUTE_CLAMP_RULE
+	};
 
-void UGGAttributeSet::OnRep_LuckyChance(const FGameplayAttributeData& OldLuckyChance)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, LuckyChance, OldLuckyChance);
-}
+	static_assert(UE_ARRAY_COUNT(ClampRules) == static_cast<int32>(EGGAttribute::Count),
+		"Every attribute needs a clamp rule");
 
-void UGGAttributeSet::OnRep_DamageAdd(const FGameplayAttributeData& OldDamageAdd)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, DamageAdd, OldDamageAdd);
+	// For each attribute, a mask of the attributes that are clamped to it
+	static const TStaticArray<uint32, static_cast<int32>(EGGAttribute::Count)>& GetDependents()
+	{
+		static const TStaticArray<uint32, static_cast<int32>(EGGAttribute::Count)> Dependents = []()
+		{
+			TStaticArray<uint32, static_cast<int32>(EGGAttribute::Count)> Result(InPlace, 0u);
+			for (int32 Index = 0; Index < static_cast<int32>(EGGAttribute::Count); ++Index)
+			{
+				if (ClampRules[Index].Type == FGGAttributeClampRule::EType::Attribute)
+				{
+					Result[static_cast<int32>(ClampRules[Index].MaxAttribute)] |= 1u << Index;
+				}
+			}
+			return Result;
+		}();
+		return Dependents;
+	}
 }
 
-void UGGAttributeSet::OnRep_DamageMulti(const FGameplayAttributeData& OldDamageMulti)
+const FGameplayAttribute& UGGAttributeSet::GetAttribute(EGGAttribute Index)
 {
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, DamageMulti, OldDamageMulti);
+	static const FGameplayAttribute Attributes[] =
+	{
+#define GG_ATTRIBUTE_PROPERTY(Name, bReplicated, ClampRule) Get##Name##Attribute(),
+		GG_ATTRIBUTE_LIST(GG_ATTRIBUTE_PROPERTY)
+#undef GG_ATTRIBUTE_PROPERTY
+	};
+	check(Index < EGGAttribute::Count);
+	return Attributes[static_cast<int32>(Index)];
 }
 
-void UGGAttributeSet::OnRep_Ammo(const FGameplayAttributeData& OldAmmo)
+EGGAttribute UGGAttributeSet::GetAttributeIndex(const FGameplayAttribute& Attribute)
 {
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, Ammo, OldAmmo);
-}
+	static const TMap<const FProperty*, EGGAttribute> PropertyToIndex = []()
+	{
+		TMap<const FProperty*, EGGAttribute> Result;
+		for (int32 Index = 0; Index < static_cast<int32>(EGGAttribute::Count); ++Index)
+		{
+			Result.Add(GetAttribute(static_cast<EGGAttribute>(Index)).GetUProperty(), static_cast<EGGAttribute>(Index));
+		}
+		return Result;
+	}();
 
-void UGGAttributeSet::OnRep_Chilled(const FGameplayAttributeData& OldChilled)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, Chilled, OldChilled);
-}
-
-void UGGAttributeSet::OnRep_DeChill(const FGameplayAttributeData& OldDeChill)
-{
-	GAMEPLAYATTRIBUTE_REPNOTIFY(UGGAttributeSet, DeChill, OldDeChill);
+	const EGGAttribute* Index = PropertyToIndex.Find(Attribute.GetUProperty());
+	return Index ? *Index : EGGAttribute::Count;
 }
 
 /**
@@ -117,21 +126,61 @@ void UGGAttributeSet::PreAttributeChange(const FGameplayAttribute& Attribute, fl
  */
 void UGGAttributeSet::ClampAttributeOnChange(const FGameplayAttribute& Attribute, float& NewValue) const
 {
-	if (Attribute == GetHealthAttribute())
+	const EGGAttribute Index = GetAttributeIndex(Attribute);
+	if (Index == EGGAttribute::Count)
 	{
-		NewValue = FMath::Clamp(NewValue, 0.f, GetHealthMax());
+		return;
 	}
-	else if (Attribute == GetArmorAttribute())
+
+	const FGGAttributeClampRule& Rule = GGAttributeTable::ClampRules[static_cast<int32>(Index)];
+	switch (Rule.Type)
 	{
-		NewValue = FMath::Clamp(NewValue, 0.f, GetArmorMax());
+	case FGGAttributeClampRule::EType::Range:
+		NewValue = FMath::Clamp(NewValue, Rule.Min, Rule.Max);
+		break;
+	case FGGAttributeClampRule::EType::Attribute:
+		NewValue = FMath::Clamp(NewValue, Rule.Min, GetAttribute(Rule.MaxAttribute).GetNumericValue(this));
+		break;
+	default:
+		break;
 	}
-	else if (Attribute == GetChilledAttribute())
+}
+
+/**
+ *  Called just after any modification happens to an attribute. When an attribute that
+ *  others are clamped to drops (such as HealthMax), those attributes are clamped again.
+ *  Only the server clamps; clients receive the clamped values through replication.
+ * @param Attribute The attribute that was modified
+ * @param OldValue The value before the change
+ * @param NewValue The value after the change
+ */
+void UGGAttributeSet::PostAttributeChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue)
+{
+	Super::PostAttributeChange(Attribute, OldValue, NewValue);
+	if (NewValue >= OldValue || !IsOwnerActorAuthoritative())
 	{
-		NewValue = FMath::Clamp(NewValue, 0.f, 100.f);
+		return;
 	}
-	else if (Attribute == GetDeChillAttribute())
+
+	const EGGAttribute Index = GetAttributeIndex(Attribute);
+	if (Index == EGGAttribute::Count)
 	{
-		NewValue = FMath::Clamp(NewValue, 0.f, 100.f);
+		return;
+	}
+
+	uint32 Dependents = GGAttributeTable::GetDependents()[static_cast<int32>(Index)];
+	UAbilitySystemComponent* AbilitySystemComponent = GetOwningAbilitySystemComponent();
+	while (Dependents != 0 && AbilitySystemComponent)
+	{
+		const int32 DependentIndex = FMath::CountTrailingZeros(Dependents);
+		Dependents &= Dependents - 1;
+
+		const FGameplayAttribute& Dependent = GetAttribute(static_cast<EGGAttribute>(DependentIndex));
+		const float DependentValue = Dependent.GetNumericValue(this);
+		if (DependentValue > NewValue)
+		{
+			AbilitySystemComponent->ApplyModToAttribute(Dependent, EGameplayModOp::Override, NewValue);
+		}
 	}
 }
 
@@ -153,22 +202,20 @@ void UGGAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallback
 		if (inDamage > 0.f)
 		{
 			
+			const FGameplayTagContainer& SpecTags = Data.EffectSpec.CapturedSourceTags.GetSpecTags();
+			const FGameplayTag AcidDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Acid"), false);
+			const FGameplayTag FireDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Fire"), false);
+			const bool isArmored = GetArmor() > 0.f;
+
+			float newArmor	= GetArmor();
+			float newHealth = GetHealth();
+			const bool isHealthDamaged = ResolveIncomingDamage(inDamage, SpecTags.HasTagExact(AcidDamageTag), SpecTags.HasTagExact(FireDamageTag),
+								  GetArmorMax(), GetHealthMax(), newArmor, newHealth);
+
 			// Apply damage to armor
-			if (GetArmor() > 0.f)
+			if (isArmored)
 			{
-				float inDamageToArmor = inDamage;
-				const FGameplayTag AcidDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Acid"), false);
-				bool isAcidDamage = Data.EffectSpec.CapturedSourceTags.GetSpecTags().HasTagExact(AcidDamageTag);
-				if (isAcidDamage)
-				{
-					inDamageToArmor *= 1.5;
-				}
-
-				float newArmor = GetArmor();
-				const float armorDiff = FMath::Min(newArmor, inDamageToArmor);
-				inDamage -= armorDiff;
-				newArmor -= armorDiff;
-				SetArmor(FMath::Clamp(newArmor, 0.f, GetArmorMax()));
+				SetArmor(newArmor);
 
 				// If the armor just ran out, trigger listeners
 				if (GetArmor() <= 0.f && !bOutOfArmor)
@@ -185,18 +232,9 @@ void UGGAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallback
 			}
 
 			// Same process, now for health
-			if (inDamage > 0.f)
+			if (isHealthDamaged)
 			{
-				float inDamageToHealth = inDamage;
-				const FGameplayTag FireDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Fire"), false);
-				bool isFireDamage = Data.EffectSpec.CapturedSourceTags.GetSpecTags().HasTagExact(FireDamageTag);
-				if (isFireDamage)
-				{
-					inDamageToHealth *= 1.5;
-				}
-				
-				const float newHealth = GetHealth() - inDamageToHealth;
-				SetHealth(FMath::Clamp(newHealth , 0.f, GetHealthMax()));
+				SetHealth(newHealth);
 				if (((GetHealth() <= 0.f) && !bOutOfHealth))
 				{
 					if (OnOutOfHealth.IsBound())
@@ -211,6 +249,9 @@ void UGGAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallback
 				bOutOfHealth = (GetHealth() <= 0.f);
 			}
 
+			// Queues the hit for clients, where it is replayed through the same events
+			UGGHitFeedbackSubsystem::AddHit(GetOwningActor(), Data.EffectSpec, Data.EvaluatedData.Magnitude);
+
 			if (OnDamageTaken.IsBound())
 			{
 				const FGameplayEffectContextHandle& ContextHandle = Data.EffectSpec.GetEffectContext();
@@ -235,25 +276,54 @@ void UGGAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallback
 	}
 }
 
-void UGGAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+/**
+ *  Splits incoming damage between armor and health. Armor absorbs damage first;
+ *  acid damage hits armor 50% harder and fire damage hits health 50% harder.
+ *  Pure function so the same rules can be run outside of an effect execution.
+ * @param InDamage The damage after all calculations, before armor
+ * @param bIsAcidDamage True if the damage carries the Damage.Type.Acid tag
+ * @param bIsFireDamage True if the damage carries the Damage.Type.Fire tag
+ * @param ArmorMax The maximum armor value used for clamping
+ * @param HealthMax The maximum health value used for clamping
+ * @param InOutArmor The current armor value, by reference (to be modified)
+ * @param InOutHealth The current health value, by reference (to be modified)
+ * @return True if any damage was left over after armor and applied to health
+ */
+bool UGGAttributeSet::ResolveIncomingDamage(float InDamage, bool bIsAcidDamage, bool bIsFireDamage,
+	float ArmorMax, float HealthMax, float& InOutArmor, float& InOutHealth)
 {
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	if (InDamage <= 0.f)
+	{
+		return false;
+	}
 
-	// Vitality Attributes
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, Health, COND_None, REPNOTIFY_Always);
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, HealthMax, COND_None, REPNOTIFY_Always);
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, Armor, COND_None, REPNOTIFY_Always);
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, ArmorMax, COND_None, REPNOTIFY_Always);
+	if (InOutArmor > 0.f)
+	{
+		const float inDamageToArmor = bIsAcidDamage ? InDamage * 1.5f : InDamage;
+		const float armorDiff = FMath::Min(InOutArmor, inDamageToArmor);
+		InDamage   -= armorDiff;
+		InOutArmor  = FMath::Clamp(InOutArmor - armorDiff, 0.f, ArmorMax);
+	}
 
-	// Critical Hit System
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, CriticalChance, COND_None, REPNOTIFY_Always);
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, CriticalMultiplier, COND_None, REPNOTIFY_Always);
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, LuckyChance, COND_None, REPNOTIFY_Always);
+	if (InDamage > 0.f)
+	{
+		const float inDamageToHealth = bIsFireDamage ? InDamage * 1.5f : InDamage;
+		InOutHealth = FMath::Clamp(InOutHealth - inDamageToHealth, 0.f, HealthMax);
+		return true;
+	}
+	return false;
+}
 
-	// Ammo Count
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, Ammo, COND_None, REPNOTIFY_Always);
+void UGGAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	// Freeze/Thaw
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, Chilled, COND_None, REPNOTIFY_Always);
-	DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, DeChill, COND_None, REPNOTIFY_Always);
+	// Every attribute in GG_ATTRIBUTE_LIST marked as replicated
+#define GG_ATTRIBUTE_REPLICATION(Name, bReplicated, ClampRule) \
+	if (bReplicated) \
+	{ \
+		DOREPLIFETIME_CONDITION_NOTIFY(UGGAttributeSet, Name, COND_None, REPNOTIFY_Always); \
+	}
+	GG_ATTRIBUTE_LIST(GG_ATTRIBUTE_REPLICATION)
+#undef GG_ATTRIBUTE_REPLICATION
 }
@@ -0,0 +1,315 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGAutoFireAbility.h"
+#include "AbilitySystemComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameplayEffect.h"
+#include "GGProjectileInterface.h"
+#include "GGShotEventSubsystem.h"
+#include "TimerManager.h"
+
+bool FGGTargetData_Shots::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 NumShots = static_cast<uint8>(FMath::Min(Shots.Num(), 255));
+	Ar << NumShots;
+	if (Ar.IsLoading())
+	{
+		Shots.SetNum(NumShots);
+	}
+
+	for (int32 i = 0; i < NumShots; ++i)
+	{
+		Shots[i].Origin.NetSerialize(Ar, Map, bOutSuccess);
+		Shots[i].Direction.NetSerialize(Ar, Map, bOutSuccess);
+		Ar << Shots[i].ShotNumber;
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+UGGAutoFireAbility::UGGAutoFireAbility()
+{
+	InstancingPolicy	= EGameplayAbilityInstancingPolicy::InstancedPerActor;
+	NetExecutionPolicy	= EGameplayAbilityNetExecutionPolicy::LocalPredicted;
+	AbilityInputID		= EAbilityInputID::Fire;
+	bBatchServerRPCs	= true;
+}
+
+/**
+ *  Starts firing. On the client the first shot is sent right away, inside the RPC batch
+ *  opened by UGGAbilitySystemComponent, so it travels with the activation.
+ *  On the server this only starts listening for shots.
+ */
+void UGGAutoFireAbility::ActivateAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	const FGameplayEventData* TriggerEventData)
+{
+	if (!CommitAbilityCooldown(Handle, ActorInfo, ActivationInfo, false))
+	{
+		EndAbility(Handle, ActorInfo, ActivationInfo, true, true);
+		return;
+	}
+
+	UAbilitySystemComponent* AbilitySystem = ActorInfo->AbilitySystemComponent.Get();
+	const FPredictionKey ActivationKey = ActivationInfo.GetActivationPredictionKey();
+
+	if (HasAuthority(&ActivationInfo))
+	{
+		ServerActivationTime = GetWorld()->GetTimeSeconds();
+		ServerShotsAccepted	 = 0;
+		LastServerShotNumber = 0;
+
+		if (!IsLocallyControlled())
+		{
+			TargetDataDelegateHandle = AbilitySystem->AbilityTargetDataSetDelegate(Handle, ActivationKey)
+				.AddUObject(this, &UGGAutoFireAbility::OnServerShotsReceived);
+
+			// The shots may have arrived before the activation was processed
+			AbilitySystem->CallReplicatedTargetDataDelegatesIfSet(Handle, ActivationKey);
+		}
+	}
+
+	if (IsLocallyControlled())
+	{
+		NextShotNumber = 0;
+		PendingShots   = 1.f;
+		LastBatchTime  = GetWorld()->GetTimeSeconds();
+		SendPendingShots();
+
+		if (IsActive())
+		{
+			GetWorld()->GetTimerManager().SetTimer(BatchTimer, this, &UGGAutoFireAbility::SendPendingShots,
+				FMath::Max(BatchInterval, 1.f / FireRate), true);
+		}
+	}
+}
+
+/**
+ *  Sends whatever shots are still owed and ends the ability, both in a single batched RPC.
+ */
+void UGGAutoFireAbility::InputReleased(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo)
+{
+	Super::InputReleased(Handle, ActorInfo, ActivationInfo);
+
+	if (!IsLocallyControlled() || !IsActive())
+	{
+		return;
+	}
+
+	FScopedServerAbilityRPCBatcher AbilityRPCBatcher(ActorInfo->AbilitySystemComponent.Get(), Handle);
+	SendPendingShots();
+	EndAbility(Handle, ActorInfo, ActivationInfo, true, false);
+}
+
+void UGGAutoFireAbility::EndAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	bool bReplicateEndAbility, bool bWasCancelled)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(BatchTimer);
+	}
+
+	if (TargetDataDelegateHandle.IsValid())
+	{
+		if (UAbilitySystemComponent* AbilitySystem = ActorInfo->AbilitySystemComponent.Get())
+		{
+			AbilitySystem->AbilityTargetDataSetDelegate(Handle, ActivationInfo.GetActivationPredictionKey())
+				.Remove(TargetDataDelegateHandle);
+			AbilitySystem->ConsumeClientReplicatedTargetData(Handle, ActivationInfo.GetActivationPredictionKey());
+		}
+		TargetDataDelegateHandle.Reset();
+	}
+
+	Super::EndAbility(Handle, ActorInfo, ActivationInfo, bReplicateEndAbility, bWasCancelled);
+}
+
+void UGGAutoFireAbility::FireShot_Implementation(const FVector& Origin, const FVector& Direction)
+{
+	AActor* Avatar = GetAvatarActorFromActorInfo();
+	if (!ProjectileClass || !Avatar)
+	{
+		return;
+	}
+
+	FGameplayEffectSpecHandle DamageSpec;
+	if (DamageEffect)
+	{
+		DamageSpec = MakeOutgoingGameplayEffectSpec(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo,
+			DamageEffect, GetAbilityLevel(CurrentSpecHandle, CurrentActorInfo));
+	}
+	if (DamageSpec.IsValid())
+	{
+		if (DamageTypeTag.IsValid())
+		{
+			DamageSpec.Data->AddDynamicAssetTag(DamageTypeTag);
+		}
+		if (Damage > 0.f)
+		{
+			static const FGameplayTag SetByCallerTag =
+				FGameplayTag::RequestGameplayTag(FName("Damage.SetByCaller"), false);
+			DamageSpec.Data->SetSetByCallerMagnitude(SetByCallerTag, Damage);
+		}
+	}
+
+	const FTransform SpawnTransform(Direction.Rotation(), Origin);
+	AActor* Projectile = GetWorld()->SpawnActorDeferred<AActor>(ProjectileClass, SpawnTransform,
+		Avatar, Cast<APawn>(Avatar), ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Projectile)
+	{
+		return;
+	}
+
+	if (Projectile->Implements<UGGProjectileInterface>())
+	{
+		IGGProjectileInterface::Execute_InitializeProjectile(Projectile, DamageSpec);
+	}
+	Projectile->FinishSpawning(SpawnTransform);
+
+	UGGShotEventSubsystem::ReplicateAsShotEvent(Projectile, CosmeticProjectileClass);
+}
+
+void UGGAutoFireAbility::GetShotOriginAndDirection(FVector& OutOrigin, FVector& OutDirection) const
+{
+	const AActor* Avatar = GetAvatarActorFromActorInfo();
+	FRotator ViewRotation;
+	Avatar->GetActorEyesViewPoint(OutOrigin, ViewRotation);
+
+	OutDirection = ViewRotation.Vector();
+	OutOrigin += OutDirection * MuzzleOffset;
+}
+
+/**
+ *  Checks a client shot against what the server knows. Shots must be in order, must not
+ *  exceed the fire rate since activation, must start near the avatar and must be affordable.
+ * @param Shot The shot reported by the client
+ * @return True if the shot should be fired
+ */
+bool UGGAutoFireAbility::ValidateShot(const FGGShotInfo& Shot)
+{
+	// Sequence comparison, so the shot number can wrap around during long bursts
+	if (ServerShotsAccepted > 0 && static_cast<int16>(Shot.ShotNumber - LastServerShotNumber) <= 0)
+	{
+		return false;
+	}
+
+	const double Elapsed = GetWorld()->GetTimeSeconds() - ServerActivationTime + FireRateTolerance;
+	const int32 AllowedShots = 1 + FMath::FloorToInt32(Elapsed * FireRate);
+	if (ServerShotsAccepted >= AllowedShots)
+	{
+		return false;
+	}
+
+	const AActor* Avatar = GetAvatarActorFromActorInfo();
+	if (!Avatar || FVector::DistSquared(Avatar->GetActorLocation(), Shot.Origin) > FMath::Square(MaxOriginError))
+	{
+		return false;
+	}
+
+	if (!CommitAbilityCost(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo))
+	{
+		return false;
+	}
+
+	LastServerShotNumber = Shot.ShotNumber;
+	++ServerShotsAccepted;
+	return true;
+}
+
+/**
+ *  Generates every shot owed at FireRate since the last batch and sends them to the
+ *  server as one target data RPC. When called inside a FScopedServerAbilityRPCBatcher the
+ *  target data is folded into that batch instead.
+ */
+void UGGAutoFireAbility::SendPendingShots()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	PendingShots += static_cast<float>(Now - LastBatchTime) * FireRate;
+	LastBatchTime = Now;
+
+	const int32 NumShots = FMath::Min(FMath::FloorToInt32(PendingShots), MaxShotsPerBatch);
+	if (NumShots <= 0)
+	{
+		return;
+	}
+	PendingShots = FMath::Min(PendingShots - NumShots, 1.f);
+
+	FGGTargetData_Shots* ShotData = new FGGTargetData_Shots();
+	ShotData->Shots.Reserve(NumShots);
+
+	for (int32 i = 0; i < NumShots; ++i)
+	{
+		if (!CheckCost(CurrentSpecHandle, CurrentActorInfo))
+		{
+			break;
+		}
+
+		FVector Origin, Direction;
+		GetShotOriginAndDirection(Origin, Direction);
+
+		FGGShotInfo& Shot = ShotData->Shots.AddDefaulted_GetRef();
+		Shot.Origin		= Origin;
+		Shot.Direction	= Direction;
+		Shot.ShotNumber = NextShotNumber++;
+
+		OnShotPredicted(Origin, Direction);
+	}
+
+	if (ShotData->Shots.Num() == 0)
+	{
+		// Out of ammo
+		delete ShotData;
+		K2_EndAbility();
+		return;
+	}
+
+	FGameplayAbilityTargetDataHandle DataHandle(ShotData);
+	UAbilitySystemComponent* AbilitySystem = CurrentActorInfo->AbilitySystemComponent.Get();
+
+	if (HasAuthority(&CurrentActivationInfo))
+	{
+		// Listen server or standalone; nothing to send
+		for (const FGGShotInfo& Shot : ShotData->Shots)
+		{
+			if (ValidateShot(Shot))
+			{
+				FireShot(Shot.Origin, Shot.Direction);
+			}
+		}
+		return;
+	}
+
+	AbilitySystem->CallServerSetReplicatedTargetData(CurrentSpecHandle,
+		CurrentActivationInfo.GetActivationPredictionKey(), DataHandle, FGameplayTag(),
+		AbilitySystem->ScopedPredictionKey);
+}
+
+void UGGAutoFireAbility::OnServerShotsReceived(const FGameplayAbilityTargetDataHandle& Data, FGameplayTag ActivationTag)
+{
+	if (UAbilitySystemComponent* AbilitySystem = CurrentActorInfo->AbilitySystemComponent.Get())
+	{
+		AbilitySystem->ConsumeClientReplicatedTargetData(CurrentSpecHandle,
+			CurrentActivationInfo.GetActivationPredictionKey());
+	}
+
+	for (int32 i = 0; i < Data.Num(); ++i)
+	{
+		const FGameplayAbilityTargetData* TargetData = Data.Get(i);
+		if (!TargetData || TargetData->GetScriptStruct() != FGGTargetData_Shots::StaticStruct())
+		{
+			continue;
+		}
+
+		for (const FGGShotInfo& Shot : static_cast<const FGGTargetData_Shots*>(TargetData)->Shots)
+		{
+			if (ValidateShot(Shot))
+			{
+				FireShot(Shot.Origin, Shot.Direction);
+			}
+		}
+	}
+}
@@ -2,19 +2,42 @@
 
 #include "GGCharacterBase.h"
 #include "Engine/LocalPlayer.h"
-#include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/PlayerState.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "GGAbilitySystemComponent.h"
 #include "GGAttributeSet.h"
+#include "GGDamageOverTimeSubsystem.h"
+#include "GGDeathPresentationSubsystem.h"
+#include "GGDeferredWorkSubsystem.h"
+#include "GGHitFeedbackSubsystem.h"
+#include "GGHitZoneData.h"
+#include "GGLagCompensationSubsystem.h"
+#include "GGPreloadSubsystem.h"
+#include "GGProjectileAbility.h"
+#include "GGProjectileAbilityData.h"
+#include "Net/UnrealNetwork.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
 
 DEFINE_LOG_CATEGORY(LogCharacterBase);
 
+static bool bDamagePredictionEnabled = true;
+static FAutoConsoleVariableRef CVarDamagePredictionEnabled(
+	TEXT("gg.DamagePrediction.Enabled"), bDamagePredictionEnabled,
+	TEXT("If true, clients show the damage of their own hits before the server confirms it."));
+
+static float DamagePredictionTimeout = 0.5f;
+static FAutoConsoleVariableRef CVarDamagePredictionTimeout(
+	TEXT("gg.DamagePrediction.Timeout"), DamagePredictionTimeout,
+	TEXT("Seconds a predicted hit is shown without confirmation from the server before it is rolled back."));
+
 //////////////////////////////////////////////////////////////////////////
 // AGGCharacterBase
 
@@ -41,23 +64,19 @@ AGGCharacterBase::AGGCharacterBase()
 	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
 	GetCharacterMovement()->BrakingDecelerationFalling = 1500.0f;
 
-	// Create a camera boom (pulls in towards the player if there is a collision)
-	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
-	CameraBoom->SetupAttachment(RootComponent);
-	CameraBoom->TargetArmLength = 400.0f; // The camera follows at this distance behind the character	
-	CameraBoom->bUsePawnControlRotation = true; // Rotate the arm based on the controller
-
-	// Create a follow camera
-	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
-	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
-	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	// Cameras are only created by player characters (see ACookingWithGasCharacter); CameraBoom and FollowCamera stay null here
 
-	AbilitySystemComponent = CreateDefaultSubobject<UAbilitySystemComponent>("AbilitySystemComp");
+	AbilitySystemComponent = CreateDefaultSubobject<UGGAbilitySystemComponent>("AbilitySystemComp");
 	AbilitySystemComponent->SetIsReplicated(true);
 	AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
 
 	AttributeSet = CreateDefaultSubobject<UGGAttributeSet>("AttributeSet");
 
+	// Headshots are critical hits, so the head is checked against its past positions
+	FGGRewindBone& HeadBone = RewindBones.AddDefaulted_GetRef();
+	HeadBone.BoneName = TEXT("head");
+	HeadBone.Radius	  = 15.f;
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
@@ -90,6 +109,22 @@ void AGGCharacterBase::BeginPlay()
 	// Triggers 'OnDamageTakenChanged' listeners when the attribute set
 	// Broadcasts that damage has been processed
 	AttributeSet->OnDamageTaken.AddUObject(this, &AGGCharacterBase::OnDamageTakenChanged);
+
+	if (HitZones)
+	{
+		BoneHitZones = HitZones->GetBoneZones(GetMesh()->GetSkeletalMeshAsset());
+	}
+
+	DisplayedHealth = AttributeSet->GetHealth();
+	DisplayedArmor	= AttributeSet->GetArmor();
+
+	if (HasAuthority())
+	{
+		if (UGGLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UGGLagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterCharacter(this);
+		}
+	}
 }
 
 UAbilitySystemComponent* AGGCharacterBase::GetAbilitySystemComponent() const
@@ -97,6 +132,24 @@ UAbilitySystemComponent* AGGCharacterBase::GetAbilitySystemComponent() const
 	return AbilitySystemComponent;
 }
 
+uint8 AGGCharacterBase::GetHitZoneId(FName BoneName) const
+{
+	if (!BoneHitZones.IsValid() || BoneName.IsNone())
+	{
+		return 0;
+	}
+
+	const int32 BoneIndex = GetMesh()->GetBoneIndex(BoneName);
+	return BoneHitZones->IsValidIndex(BoneIndex) ? (*BoneHitZones)[BoneIndex] : 0;
+}
+
+void AGGCharacterBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AGGCharacterBase, DeathPose);
+}
+
 void AGGCharacterBase::PossessedBy(AController* NewController)
 {
 	Super::PossessedBy(NewController);
@@ -126,15 +179,42 @@ void AGGCharacterBase::InitializeAbilities()
 	if (!HasAuthority() || !AbilitySystemComponent)
 		return;
 
-	for (TSubclassOf<UGGGameplayAbility>& Ability : DefaultAbilities)
+	for (const TSoftClassPtr<UGGGameplayAbility>& SoftAbility : DefaultAbilities)
 	{
+		const TSubclassOf<UGGGameplayAbility> Ability =
+			UGGPreloadSubsystem::GetOrLoadClass(this, SoftAbility.ToSoftObjectPath());
+		if (!Ability)
+		{
+			continue;
+		}
+
 		AbilitySystemComponent->GiveAbility(
 			FGameplayAbilitySpec(Ability, 1,
 				static_cast<int32>(Ability.GetDefaultObject()->AbilityInputID), this));
 	}
+
+	// Projectile abilities are non-instanced; the data asset tells them what to fire
+	for (UGGProjectileAbilityData* ProjectileData : DefaultProjectileAbilities)
+	{
+		if (ProjectileData && ProjectileData->AbilityClass)
+		{
+			AbilitySystemComponent->GiveAbility(
+				FGameplayAbilitySpec(ProjectileData->AbilityClass, 1,
+					static_cast<int32>(ProjectileData->AbilityInputID), ProjectileData));
+		}
+	}
 }
 
 void AGGCharacterBase::InitializeEffects()
+{
+	// A whole wave spawning on one frame would otherwise apply every default effect on that frame
+	UGGDeferredWorkSubsystem::Submit(this, EGGDeferredWorkPriority::High, this, [this]()
+	{
+		ApplyDefaultEffects();
+	});
+}
+
+void AGGCharacterBase::ApplyDefaultEffects()
 {
 	if (!AbilitySystemComponent)
 	{
@@ -144,8 +224,10 @@ void AGGCharacterBase::InitializeEffects()
 	FGameplayEffectContextHandle EffectContext = AbilitySystemComponent->MakeEffectContext();
 	EffectContext.AddSourceObject(this);
 
-	for (TSubclassOf<UGameplayEffect>& Effect : DefaultEffects)
+	for (const TSoftClassPtr<UGameplayEffect>& SoftEffect : DefaultEffects)
 	{
+		const TSubclassOf<UGameplayEffect> Effect =
+			UGGPreloadSubsystem::GetOrLoadClass(this, SoftEffect.ToSoftObjectPath());
 		FGameplayEffectSpecHandle SpecHandle =
 			AbilitySystemComponent->MakeOutgoingSpec(Effect, 1, EffectContext);
 		
@@ -163,6 +245,19 @@ void AGGCharacterBase::InitializeEffects()
  */
 void AGGCharacterBase::OnHealthAttributeChanged(const FOnAttributeChangeData& Data)
 {
+	if (PredictedHits.Num() > 0)
+	{
+		// Damage from the server may include predicted hits, even if their hit feedback was lost;
+		// the others are resolved on top of the new value
+		if (Data.NewValue < Data.OldValue)
+		{
+			ConfirmPredictedHits();
+		}
+		RefreshDisplayedVitals();
+		return;
+	}
+
+	DisplayedHealth = Data.NewValue;
 	OnAttributeUpdated.Broadcast(Data.Attribute, Data.NewValue);
 	
 	// Calls the blueprint event
@@ -175,6 +270,17 @@ void AGGCharacterBase::OnHealthAttributeChanged(const FOnAttributeChangeData& Da
  */
 void AGGCharacterBase::OnArmorAttributeChanged(const FOnAttributeChangeData& Data)
 {
+	if (PredictedHits.Num() > 0)
+	{
+		if (Data.NewValue < Data.OldValue)
+		{
+			ConfirmPredictedHits();
+		}
+		RefreshDisplayedVitals();
+		return;
+	}
+
+	DisplayedArmor = Data.NewValue;
 	OnAttributeUpdated.Broadcast(Data.Attribute, Data.NewValue);
 	
 	// Calls the blueprint event
@@ -193,9 +299,32 @@ void AGGCharacterBase::OnOutOfHealthChanged(AActor* DamageInstigator, AActor* Da
 	const FGameplayEffectSpec& DamageSpec, float DamageMagnitude)
 {
 	OnHealthDepleted.Broadcast();
+
+	// Set before HandleDeath, which may cull corpses, so this one is kept until its event has run
+	bDeathEventPending = true;
+
+	// The server settles the body without simulating it; clients present the death on their side
+	if (HasAuthority() && !DeathPose.bIsDead)
+	{
+		DeathPose = UGGDeathPresentationSubsystem::MakeRestingPose(this);
+		if (UGGDeathPresentationSubsystem* DeathPresentation = GetWorld()->GetSubsystem<UGGDeathPresentationSubsystem>())
+		{
+			DeathPresentation->HandleDeath(this);
+		}
+
+		// Burns and acid stop with the character instead of ticking on the corpse
+		UGGDamageOverTimeSubsystem::ClearDamageOverTime(this);
+	}
 	
-	// Calls the blueprint event
-	OnOutOfHealth(DamageInstigator, DamageCauser, DamageSpec, DamageMagnitude);
+	// Calls the blueprint event on a later frame; it runs the death presentation and cleanup,
+	// which would otherwise all land on the frame a wave dies
+	UGGDeferredWorkSubsystem::Submit(this, EGGDeferredWorkPriority::Normal, this,
+		[this, WeakInstigator = TWeakObjectPtr<AActor>(DamageInstigator),
+			   WeakCauser = TWeakObjectPtr<AActor>(DamageCauser), DamageSpec, DamageMagnitude]()
+	{
+		bDeathEventPending = false;
+		OnOutOfHealth(WeakInstigator.Get(), WeakCauser.Get(), DamageSpec, DamageMagnitude);
+	});
 }
 
 /**
@@ -224,24 +353,318 @@ void AGGCharacterBase::OnDamageTakenChanged(AActor* DamageInstigator, AActor* Da
 	OnDamageTaken(DamageInstigator, DamageCauser, DamageTags, DamageMagnitude, isCritical, isLucky);
 }
 
+/**
+ *  Replays a hit sent by the server's UGGHitFeedbackSubsystem through the same events the
+ *  server fired when the damage was applied.
+ * @param Event The unpacked hit
+ */
+void AGGCharacterBase::ReceiveHitFeedback(const FGGHitFeedbackEvent& Event)
+{
+	LastDamageLocation = Event.Location;
+	LastDamageHitZone  = Event.HitZone;
+	if (PredictedHits.Num() > 0)
+	{
+		AcknowledgePredictedHit(Event.Instigator.Get());
+	}
+
+	FGameplayTagContainer DamageTags;
+	if (Event.DamageType.IsValid())
+	{
+		DamageTags.AddTagFast(Event.DamageType);
+	}
+	OnDamageTakenChanged(Event.Instigator.Get(), nullptr, DamageTags, Event.Magnitude, Event.bIsCritical, Event.bIsLucky);
+}
+
+/**
+ *  Predicts a hit of the local player: the damage goes through the same armor-then-health
+ *  resolution as on the server and is shown at once. Critical and lucky rolls are left to
+ *  the server, whose values take over when they arrive.
+ * @param DamageInstigator The local player's pawn
+ * @param Damage The base damage of the hit
+ * @param DamageType The Damage.Type tag of the hit; acid and fire change how armor and health are hit
+ */
+void AGGCharacterBase::PredictDamage(AActor* DamageInstigator, float Damage, FGameplayTag DamageType)
+{
+	if (!bDamagePredictionEnabled || HasAuthority() || !AttributeSet || IsDead() || Damage <= 0.f)
+	{
+		return;
+	}
+
+	// Replicated values; the client has no aggregators to evaluate conditional modifiers with
+	if (const UAbilitySystemComponent* InstigatorComponent =
+		UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(DamageInstigator))
+	{
+		if (InstigatorComponent->GetSet<UGGAttributeSet>())
+		{
+			Damage = (Damage + InstigatorComponent->GetNumericAttribute(UGGAttributeSet::GetDamageAddAttribute()))
+				* InstigatorComponent->GetNumericAttribute(UGGAttributeSet::GetDamageMultiAttribute());
+		}
+	}
+
+	static const FGameplayTag AcidDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Acid"), false);
+	static const FGameplayTag FireDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Fire"), false);
+
+	// The server cannot have applied the hit before a round trip has passed
+	const APawn* InstigatorPawn = Cast<APawn>(DamageInstigator);
+	const APlayerState* InstigatorState = InstigatorPawn ? InstigatorPawn->GetPlayerState() : nullptr;
+	const double RoundTrip = InstigatorState ? InstigatorState->GetPingInMilliseconds() / 1000.0 : 0.0;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	FPredictedHit& Hit	= PredictedHits.AddDefaulted_GetRef();
+	Hit.Instigator		= DamageInstigator;
+	Hit.Damage			= Damage;
+	Hit.bIsAcidDamage	= DamageType.IsValid() && DamageType == AcidDamageTag;
+	Hit.bIsFireDamage	= DamageType.IsValid() && DamageType == FireDamageTag;
+	Hit.ConfirmTime		= Now + RoundTrip;
+	Hit.ExpireTime		= Now + DamagePredictionTimeout;
+
+	if (!GetWorldTimerManager().IsTimerActive(PredictedHitExpiryTimer))
+	{
+		GetWorldTimerManager().SetTimer(PredictedHitExpiryTimer, this,
+			&AGGCharacterBase::ExpirePredictedHits, DamagePredictionTimeout, false);
+	}
+
+	RefreshDisplayedVitals();
+}
+
+void AGGCharacterBase::RefreshDisplayedVitals()
+{
+	float Armor	 = AttributeSet->GetArmor();
+	float Health = AttributeSet->GetHealth();
+	for (const FPredictedHit& Hit : PredictedHits)
+	{
+		UGGAttributeSet::ResolveIncomingDamage(Hit.Damage, Hit.bIsAcidDamage, Hit.bIsFireDamage,
+			AttributeSet->GetArmorMax(), AttributeSet->GetHealthMax(), Armor, Health);
+	}
+
+	if (Armor != DisplayedArmor)
+	{
+		const float OldArmor = DisplayedArmor;
+		DisplayedArmor = Armor;
+		OnAttributeUpdated.Broadcast(AttributeSet->GetArmorAttribute(), Armor);
+		OnArmorChanged(OldArmor, Armor);
+	}
+
+	if (Health != DisplayedHealth)
+	{
+		const float OldHealth = DisplayedHealth;
+		DisplayedHealth = Health;
+		OnAttributeUpdated.Broadcast(AttributeSet->GetHealthAttribute(), Health);
+		OnHealthChanged(OldHealth, Health);
+	}
+}
+
+/**
+ *  Drops the oldest pending prediction of the instigator, now that the server's hit has arrived.
+ *  Replicated health and armor may already include the hit, so keeping the prediction until
+ *  the next update could show its damage twice.
+ * @param DamageInstigator The instigator of the confirmed hit
+ */
+void AGGCharacterBase::AcknowledgePredictedHit(const AActor* DamageInstigator)
+{
+	const int32 Index = PredictedHits.IndexOfByPredicate([DamageInstigator](const FPredictedHit& Hit)
+	{
+		return Hit.Instigator.Get() == DamageInstigator;
+	});
+	if (Index != INDEX_NONE)
+	{
+		PredictedHits.RemoveAt(Index);
+		RefreshDisplayedVitals();
+	}
+}
+
+/**
+ *  Drops the predictions older than a round trip once the server's damage replicates. Hit
+ *  feedback is unreliable and can be turned off, so replicated vitals must confirm hits too;
+ *  younger predictions cannot be part of them yet and stay shown.
+ */
+void AGGCharacterBase::ConfirmPredictedHits()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	PredictedHits.RemoveAll([Now](const FPredictedHit& Hit) { return Hit.ConfirmTime <= Now; });
+}
+
+void AGGCharacterBase::ExpirePredictedHits()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	PredictedHits.RemoveAll([Now](const FPredictedHit& Hit) { return Hit.ExpireTime <= Now; });
+
+	// Hits are oldest first, so the first one expires next
+	if (PredictedHits.Num() > 0)
+	{
+		GetWorldTimerManager().SetTimer(PredictedHitExpiryTimer, this, &AGGCharacterBase::ExpirePredictedHits,
+			FMath::Max(static_cast<float>(PredictedHits[0].ExpireTime - Now), 0.01f), false);
+	}
+
+	RefreshDisplayedVitals();
+}
+
+void AGGCharacterBase::OnRep_DeathPose()
+{
+	if (!DeathPose.bIsDead)
+	{
+		return;
+	}
+
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	SetActorLocationAndRotation(DeathPose.Location, FRotator(0.f, DeathPose.Yaw, 0.f));
+
+	if (UGGDeathPresentationSubsystem* DeathPresentation = GetWorld()->GetSubsystem<UGGDeathPresentationSubsystem>())
+	{
+		DeathPresentation->HandleDeath(this);
+	}
+}
+
 void AGGCharacterBase::OnFireAbility(const FInputActionValue& Value)
 {
 	SendAbilityLocalInput(Value, static_cast<int32>(EAbilityInputID::Fire));
 }
 
+void AGGCharacterBase::OnFireAbilityReleased(const FInputActionValue& Value)
+{
+	SetAbilityInputPressed(static_cast<int32>(EAbilityInputID::Fire), false);
+}
+
+void AGGCharacterBase::OnAbilityInputTagPressed(FGameplayTag InputTag)
+{
+	if (UGGAbilitySystemComponent* GGAbilitySystem = Cast<UGGAbilitySystemComponent>(AbilitySystemComponent))
+	{
+		GGAbilitySystem->AbilityInputTagPressed(InputTag);
+	}
+}
+
+void AGGCharacterBase::OnAbilityInputTagReleased(FGameplayTag InputTag)
+{
+	if (UGGAbilitySystemComponent* GGAbilitySystem = Cast<UGGAbilitySystemComponent>(AbilitySystemComponent))
+	{
+		GGAbilitySystem->AbilityInputTagReleased(InputTag);
+	}
+}
+
 void AGGCharacterBase::SendAbilityLocalInput(const FInputActionValue& Value, int32 InputID)
 {
-	if (!AbilitySystemComponent)
+	SetAbilityInputPressed(InputID, Value.Get<bool>());
+}
+
+/**
+ *  Detects press and release edges for an ability input and forwards only those
+ *  to the AbilitySystemComponent. Repeated presses while held are ignored, and presses
+ *  for abilities that cannot activate yet are buffered for AbilityInputBufferTime.
+ * @param InputID The EAbilityInputID of the input, as an integer
+ * @param bPressed The current state of the input
+ */
+void AGGCharacterBase::SetAbilityInputPressed(int32 InputID, bool bPressed)
+{
+	if (!AbilitySystemComponent || InputID <= static_cast<int32>(EAbilityInputID::None)
+		|| InputID >= static_cast<int32>(EAbilityInputID::MAX))
+	{
+		return;
+	}
+
+	const uint32 InputBit = 1u << InputID;
+	const bool bWasPressed = (AbilityInputHeldMask & InputBit) != 0;
+	if (bWasPressed == bPressed)
 	{
+		// Not an edge, nothing changed for the ability system
 		return;
 	}
 
-	if (Value.Get<bool>())
+	if (bPressed)
 	{
+		AbilityInputHeldMask |= InputBit;
+		if (AbilityInputBufferTime > 0.f && IsAbilityInputBlocked(InputID))
+		{
+			AbilityInputBufferedMask |= InputBit;
+			AbilityInputBufferExpiry[InputID] = GetWorld()->GetTimeSeconds() + AbilityInputBufferTime;
+			if (!GetWorldTimerManager().IsTimerActive(AbilityInputBufferTimer))
+			{
+				GetWorldTimerManager().SetTimer(AbilityInputBufferTimer, this,
+					&AGGCharacterBase::FlushBufferedAbilityInput, AbilityInputBufferRetryInterval, true);
+			}
+			return;
+		}
 		AbilitySystemComponent->AbilityLocalInputPressed(InputID);
 	}
 	else
 	{
-		AbilitySystemComponent->AbilityLocalInputReleased(InputID);
+		// A buffered tap stays buffered; FlushBufferedAbilityInput sends its press and release together.
+		// The ability system never saw an expired press, so it does not get its release either.
+		AbilityInputHeldMask &= ~InputBit;
+		if ((AbilityInputExpiredMask & InputBit) != 0)
+		{
+			AbilityInputExpiredMask &= ~InputBit;
+		}
+		else if ((AbilityInputBufferedMask & InputBit) == 0)
+		{
+			AbilitySystemComponent->AbilityLocalInputReleased(InputID);
+		}
+	}
+}
+
+bool AGGCharacterBase::IsAbilityInputBlocked(int32 InputID) const
+{
+	const UGGAbilitySystemComponent* GGAbilitySystem = Cast<UGGAbilitySystemComponent>(AbilitySystemComponent);
+	if (!GGAbilitySystem)
+	{
+		return false;
 	}
-}
\ No newline at end of file
+
+	const FGameplayAbilityActorInfo* ActorInfo = AbilitySystemComponent->AbilityActorInfo.Get();
+	bool bHasAbility = false;
+	
+	for (const FGameplayAbilitySpecHandle& Handle : GGAbilitySystem->GetAbilityHandlesForInput(InputID))
+	{
+		const FGameplayAbilitySpec* Spec = GGAbilitySystem->FindAbilitySpecFromHandleFast(Handle);
+		if (!Spec || !Spec->Ability)
+		{
+			continue;
+		}
+		
+		bHasAbility = true;
+		if (!Spec->IsActive() && Spec->Ability->CanActivateAbility(Spec->Handle, ActorInfo))
+		{
+			return false;
+		}
+	}
+	
+	// Inputs without abilities (such as confirm/cancel) are never buffered
+	return bHasAbility;
+}
+
+void AGGCharacterBase::FlushBufferedAbilityInput()
+{
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	
+	for (int32 InputID = 0; InputID < static_cast<int32>(EAbilityInputID::MAX); ++InputID)
+	{
+		const uint32 InputBit = 1u << InputID;
+		if ((AbilityInputBufferedMask & InputBit) == 0)
+		{
+			continue;
+		}
+
+		if (WorldTime > AbilityInputBufferExpiry[InputID])
+		{
+			AbilityInputBufferedMask &= ~InputBit;
+			AbilityInputExpiredMask |= AbilityInputHeldMask & InputBit;
+		}
+		else if (AbilitySystemComponent && !IsAbilityInputBlocked(InputID))
+		{
+			AbilityInputBufferedMask &= ~InputBit;
+			AbilitySystemComponent->AbilityLocalInputPressed(InputID);
+
+			// The button was let go while buffered, so this was a tap
+			if ((AbilityInputHeldMask & InputBit) == 0)
+			{
+				AbilitySystemComponent->AbilityLocalInputReleased(InputID);
+			}
+		}
+	}
+
+	if (AbilityInputBufferedMask == 0)
+	{
+		GetWorldTimerManager().ClearTimer(AbilityInputBufferTimer);
+	}
+}
@@ -0,0 +1,393 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGCombatRecorder.h"
+#include "AbilitySystemComponent.h"
+#include "GameplayEffect.h"
+#include "GGAttributeSet.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY(LogCombatRecorder);
+
+static bool bCombatRecordAutoStart = false;
+static FAutoConsoleVariableRef CVarCombatRecordAutoStart(
+	TEXT("gg.CombatRecord.AutoStart"), bCombatRecordAutoStart,
+	TEXT("Starts a combat recording for every server game world when it begins play."));
+
+static int32 CombatRecordMaxSizeMB = 256;
+static FAutoConsoleVariableRef CVarCombatRecordMaxSizeMB(
+	TEXT("gg.CombatRecord.MaxSizeMB"), CombatRecordMaxSizeMB,
+	TEXT("Recording stops once the file reaches this size, in megabytes."));
+
+static int32 CombatRecordFlushKB = 64;
+static FAutoConsoleVariableRef CVarCombatRecordFlushKB(
+	TEXT("gg.CombatRecord.FlushKB"), CombatRecordFlushKB,
+	TEXT("Size of the in-memory record buffer before it is written to disk, in kilobytes."));
+
+static FAutoConsoleCommandWithWorldAndArgs CmdCombatRecordStart(
+	TEXT("gg.CombatRecord.Start"),
+	TEXT("Starts recording damage applications on the server. Optional argument: recording name."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGGCombatRecorder* Recorder = UGGCombatRecorder::Get(World))
+		{
+			Recorder->StartRecording(Args.Num() > 0 ? Args[0] : FString());
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs CmdCombatRecordStop(
+	TEXT("gg.CombatRecord.Stop"),
+	TEXT("Stops the current damage recording."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGGCombatRecorder* Recorder = UGGCombatRecorder::Get(World))
+		{
+			Recorder->StopRecording();
+		}
+	}));
+
+//////////////////////////////////////////////////////////////////////////
+// FGGCombatDamageRecord
+
+FGGDamageRollInputs FGGCombatDamageRecord::GetRollInputs() const
+{
+	FGGDamageRollInputs Inputs;
+	Inputs.InDamage			  = InDamage;
+	Inputs.CriticalChance	  = CriticalChance;
+	Inputs.CriticalMultiplier = CriticalMultiplier;
+	Inputs.LuckyChance		  = LuckyChance;
+	Inputs.bIsHeadshot		  = (Flags & GGCombatRecordFlags::Headshot) != 0;
+	return Inputs;
+}
+
+FArchive& operator<<(FArchive& Ar, FGGCombatDamageRecord& Record)
+{
+	// IDs are small and sequential, so they are packed
+	Ar << Record.WorldTime;
+	Ar.SerializeIntPacked(Record.SourceID);
+	Ar.SerializeIntPacked(Record.TargetID);
+	Ar.SerializeIntPacked(Record.EffectID);
+	Ar << Record.EffectLevel;
+	Ar << Record.RandomSeed;
+	Ar << Record.Flags;
+	Ar << Record.InDamage;
+	Ar << Record.CriticalChance;
+	Ar << Record.CriticalMultiplier;
+	Ar << Record.LuckyChance;
+	Ar << Record.TargetHealth;
+	Ar << Record.TargetHealthMax;
+	Ar << Record.TargetArmor;
+	Ar << Record.TargetArmorMax;
+	Ar << Record.OutDamage;
+	return Ar;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FGGCombatRecordReader
+
+bool FGGCombatRecordReader::Open(const FString& InFilePath)
+{
+	Data.Reset();
+	ActorNames.Reset();
+	EffectNames.Reset();
+
+	if (!FFileHelper::LoadFileToArray(Data, *InFilePath))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Reader.IsError() || Magic != UGGCombatRecorder::StreamMagic || Version != UGGCombatRecorder::StreamVersion)
+	{
+		UE_LOG(LogCombatRecorder, Error, TEXT("'%s' is not a combat recording (version %d)"),
+			*InFilePath, UGGCombatRecorder::StreamVersion);
+		return false;
+	}
+
+	FirstRecordOffset = Reader.Tell();
+	Offset = FirstRecordOffset;
+	return true;
+}
+
+bool FGGCombatRecordReader::ReadNext(FGGCombatDamageRecord& OutRecord)
+{
+	FMemoryReader Reader(Data);
+	Reader.Seek(Offset);
+
+	while (!Reader.AtEnd())
+	{
+		uint8 RecordType = 0;
+		Reader << RecordType;
+
+		switch (static_cast<EGGCombatRecordType>(RecordType))
+		{
+		case EGGCombatRecordType::ActorName:
+		case EGGCombatRecordType::EffectName:
+			{
+				uint32 ID = 0;
+				FString Name;
+				Reader.SerializeIntPacked(ID);
+				Reader << Name;
+				TMap<uint32, FString>& Names =
+					RecordType == static_cast<uint8>(EGGCombatRecordType::ActorName) ? ActorNames : EffectNames;
+				Names.Add(ID, MoveTemp(Name));
+				break;
+			}
+		case EGGCombatRecordType::Damage:
+			Reader << OutRecord;
+			Offset = Reader.Tell();
+			return !Reader.IsError();
+		default:
+			UE_LOG(LogCombatRecorder, Error, TEXT("Unknown record type %d at offset %lld"), RecordType, Reader.Tell());
+			Offset = Data.Num();
+			return false;
+		}
+
+		if (Reader.IsError())
+		{
+			break;
+		}
+	}
+
+	Offset = Data.Num();
+	return false;
+}
+
+void FGGCombatRecordReader::Rewind()
+{
+	Offset = FirstRecordOffset;
+}
+
+const FString& FGGCombatRecordReader::GetActorName(uint32 ActorID) const
+{
+	static const FString Unknown(TEXT("Unknown"));
+	const FString* Name = ActorNames.Find(ActorID);
+	return Name ? *Name : Unknown;
+}
+
+const FString& FGGCombatRecordReader::GetEffectName(uint32 EffectID) const
+{
+	static const FString Unknown(TEXT("Unknown"));
+	const FString* Name = EffectNames.Find(EffectID);
+	return Name ? *Name : Unknown;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UGGCombatRecorder
+
+UGGCombatRecorder* UGGCombatRecorder::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UGGCombatRecorder>() : nullptr;
+}
+
+bool UGGCombatRecorder::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGGCombatRecorder::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (bCombatRecordAutoStart && GetWorld()->GetNetMode() != NM_Client)
+	{
+		StartRecording();
+	}
+}
+
+void UGGCombatRecorder::Deinitialize()
+{
+	StopRecording();
+	Super::Deinitialize();
+}
+
+/**
+ *  Opens a new recording file under Saved/CombatRecordings and writes the stream header.
+ * @param RecordingName The file name to use, without extension; generated when empty
+ * @return True if the file was opened
+ */
+bool UGGCombatRecorder::StartRecording(const FString& RecordingName)
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogCombatRecorder, Warning, TEXT("Combat recording is only available on the server"));
+		return false;
+	}
+
+	StopRecording();
+
+	const FString BaseName = RecordingName.IsEmpty()
+		? FString::Printf(TEXT("Combat_%s"), *FDateTime::Now().ToString())
+		: RecordingName;
+	FilePath = FPaths::ProjectSavedDir() / TEXT("CombatRecordings") / BaseName + TEXT(".ggrec");
+
+	FileWriter.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!FileWriter.IsValid())
+	{
+		UE_LOG(LogCombatRecorder, Error, TEXT("Unable to open '%s' for recording"), *FilePath);
+		return false;
+	}
+
+	ActorIDs.Reset();
+	EffectIDs.Reset();
+	BytesWritten = 0;
+	PendingBytes.Reset();
+	PendingBytes.Reserve(CombatRecordFlushKB * 1024);
+
+	FMemoryWriter Writer(PendingBytes, false, true);
+	uint32 Magic = StreamMagic;
+	uint16 Version = StreamVersion;
+	Writer << Magic;
+	Writer << Version;
+
+	UE_LOG(LogCombatRecorder, Log, TEXT("Recording combat to '%s'"), *FilePath);
+	return true;
+}
+
+void UGGCombatRecorder::StopRecording()
+{
+	if (!FileWriter.IsValid())
+	{
+		return;
+	}
+
+	Flush();
+	FileWriter->Close();
+	FileWriter.Reset();
+
+	UE_LOG(LogCombatRecorder, Log, TEXT("Stopped combat recording '%s' (%lld bytes)"), *FilePath, BytesWritten);
+}
+
+/**
+ *  Serializes a damage application into the pending buffer. Name entries for
+ *  actors and effects are written the first time they are seen.
+ */
+void UGGCombatRecorder::RecordDamage(const UAbilitySystemComponent* SourceComponent,
+	const UAbilitySystemComponent* TargetComponent, const FGameplayEffectSpec& EffectSpec,
+	const FGGDamageRollInputs& RollInputs, int32 RandomSeed, bool bIsCritical, bool bIsLucky, float OutDamage)
+{
+	if (!FileWriter.IsValid() || !IsValid(TargetComponent))
+	{
+		return;
+	}
+
+	FGGCombatDamageRecord Record;
+	Record.WorldTime	= GetWorld()->GetTimeSeconds();
+	Record.SourceID		= GetActorID(IsValid(SourceComponent) ? SourceComponent->GetAvatarActor() : nullptr);
+	Record.TargetID		= GetActorID(TargetComponent->GetAvatarActor());
+	Record.EffectID		= GetEffectID(EffectSpec.Def);
+	Record.EffectLevel	= EffectSpec.GetLevel();
+	Record.RandomSeed	= RandomSeed;
+
+	const FGameplayTagContainer& SpecTags = EffectSpec.CapturedSourceTags.GetSpecTags();
+	static const FGameplayTag AcidDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Acid"), false);
+	static const FGameplayTag FireDamageTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type.Fire"), false);
+
+	Record.Flags |= bIsCritical				? GGCombatRecordFlags::Critical	  : 0;
+	Record.Flags |= bIsLucky				? GGCombatRecordFlags::Lucky	  : 0;
+	Record.Flags |= RollInputs.bIsHeadshot	? GGCombatRecordFlags::Headshot	  : 0;
+	Record.Flags |= SpecTags.HasTagExact(AcidDamageTag) ? GGCombatRecordFlags::AcidDamage : 0;
+	Record.Flags |= SpecTags.HasTagExact(FireDamageTag) ? GGCombatRecordFlags::FireDamage : 0;
+
+	Record.InDamage				= RollInputs.InDamage;
+	Record.CriticalChance		= RollInputs.CriticalChance;
+	Record.CriticalMultiplier	= RollInputs.CriticalMultiplier;
+	Record.LuckyChance			= RollInputs.LuckyChance;
+
+	Record.TargetHealth		= TargetComponent->GetNumericAttribute(UGGAttributeSet::GetHealthAttribute());
+	Record.TargetHealthMax	= TargetComponent->GetNumericAttribute(UGGAttributeSet::GetHealthMaxAttribute());
+	Record.TargetArmor		= TargetComponent->GetNumericAttribute(UGGAttributeSet::GetArmorAttribute());
+	Record.TargetArmorMax	= TargetComponent->GetNumericAttribute(UGGAttributeSet::GetArmorMaxAttribute());
+	Record.OutDamage		= OutDamage;
+
+	FMemoryWriter Writer(PendingBytes, false, true);
+	uint8 RecordType = static_cast<uint8>(EGGCombatRecordType::Damage);
+	Writer << RecordType;
+	Writer << Record;
+
+	if (PendingBytes.Num() >= CombatRecordFlushKB * 1024)
+	{
+		Flush();
+
+		// Keeps the overhead bounded on long sessions
+		if (BytesWritten >= static_cast<int64>(CombatRecordMaxSizeMB) * 1024 * 1024)
+		{
+			UE_LOG(LogCombatRecorder, Warning, TEXT("Combat recording reached gg.CombatRecord.MaxSizeMB (%d)"),
+				CombatRecordMaxSizeMB);
+			StopRecording();
+		}
+	}
+}
+
+uint32 UGGCombatRecorder::GetActorID(const AActor* Actor)
+{
+	if (!Actor)
+	{
+		return 0;
+	}
+
+	if (const uint32* ExistingID = ActorIDs.Find(Actor))
+	{
+		return *ExistingID;
+	}
+
+	// ID 0 is reserved for "no actor"
+	uint32 NewID = ActorIDs.Num() + 1;
+	ActorIDs.Add(Actor, NewID);
+
+	FString Name = FString::Printf(TEXT("%s (%s)"), *Actor->GetName(), *GetNameSafe(Actor->GetClass()));
+	FMemoryWriter Writer(PendingBytes, false, true);
+	uint8 RecordType = static_cast<uint8>(EGGCombatRecordType::ActorName);
+	Writer << RecordType;
+	Writer.SerializeIntPacked(NewID);
+	Writer << Name;
+	return NewID;
+}
+
+uint32 UGGCombatRecorder::GetEffectID(const UObject* EffectDef)
+{
+	if (!EffectDef)
+	{
+		return 0;
+	}
+
+	if (const uint32* ExistingID = EffectIDs.Find(EffectDef))
+	{
+		return *ExistingID;
+	}
+
+	uint32 NewID = EffectIDs.Num() + 1;
+	EffectIDs.Add(EffectDef, NewID);
+
+	FString Name = GetPathNameSafe(EffectDef->GetClass());
+	FMemoryWriter Writer(PendingBytes, false, true);
+	uint8 RecordType = static_cast<uint8>(EGGCombatRecordType::EffectName);
+	Writer << RecordType;
+	Writer.SerializeIntPacked(NewID);
+	Writer << Name;
+	return NewID;
+}
+
+void UGGCombatRecorder::Flush()
+{
+	if (!FileWriter.IsValid() || PendingBytes.Num() == 0)
+	{
+		return;
+	}
+
+	FileWriter->Serialize(PendingBytes.GetData(), PendingBytes.Num());
+	BytesWritten += PendingBytes.Num();
+	PendingBytes.Reset();
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGCombatReplayCommandlet.h"
+#include "GGAttributeSet.h"
+#include "GGCombatRecorder.h"
+#include "GGEffectDamageCalc.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+
+UGGCombatReplayCommandlet::UGGCombatReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+/**
+ *  Runs every damage record of the given file through the damage roll and the
+ *  attribute set damage resolution, comparing against the recorded results.
+ * @param Params The commandlet command line
+ * @return 0 if the replay matched the recording, 1 otherwise
+ */
+int32 UGGCombatReplayCommandlet::Main(const FString& Params)
+{
+	FString FilePath;
+	if (!FParse::Value(*Params, TEXT("File="), FilePath))
+	{
+		UE_LOG(LogCombatRecorder, Error, TEXT("Usage: -run=GGCombatReplay -File=<path.ggrec> [-Loops=N] [-NoResync] [-Verbose]"));
+		return 1;
+	}
+
+	int32 Loops = 1;
+	FParse::Value(*Params, TEXT("Loops="), Loops);
+	Loops = FMath::Max(Loops, 1);
+
+	// Resync restores each target to its recorded vitality before every hit, which
+	// hides healing and regeneration that happened between hits in the live game
+	const bool bResync = !FParse::Param(*Params, TEXT("NoResync"));
+	const bool bVerbose = FParse::Param(*Params, TEXT("Verbose"));
+
+	FGGCombatRecordReader Reader;
+	if (!Reader.Open(FilePath))
+	{
+		UE_LOG(LogCombatRecorder, Error, TEXT("Unable to open combat recording '%s'"), *FilePath);
+		return 1;
+	}
+
+	// One attribute set per recorded target, outside of any world or ability system
+	TMap<uint32, UGGAttributeSet*> TargetSets;
+
+	int64  RecordCount = 0;
+	int64  Mismatches  = 0;
+	double CalcSeconds = 0.0;
+	double ResolveSeconds = 0.0;
+
+	for (int32 Loop = 0; Loop < Loops; ++Loop)
+	{
+		Reader.Rewind();
+		for (const TPair<uint32, UGGAttributeSet*>& Pair : TargetSets)
+		{
+			Pair.Value->RemoveFromRoot();
+		}
+		TargetSets.Reset();
+
+		FGGCombatDamageRecord Record;
+		while (Reader.ReadNext(Record))
+		{
+			++RecordCount;
+
+			UGGAttributeSet*& AttributeSet = TargetSets.FindOrAdd(Record.TargetID);
+			const bool bFirstHit = AttributeSet == nullptr;
+			if (bFirstHit)
+			{
+				AttributeSet = NewObject<UGGAttributeSet>(GetTransientPackage());
+				AttributeSet->AddToRoot();
+			}
+			if (bFirstHit || bResync)
+			{
+				AttributeSet->InitHealth(Record.TargetHealth);
+				AttributeSet->InitHealthMax(Record.TargetHealthMax);
+				AttributeSet->InitArmor(Record.TargetArmor);
+				AttributeSet->InitArmorMax(Record.TargetArmorMax);
+			}
+
+			const double CalcStart = FPlatformTime::Seconds();
+			FRandomStream RandomStream(Record.RandomSeed);
+			bool bIsCritical = false;
+			bool bIsLucky	 = false;
+			const float OutDamage = UGGEffectDamageCalc::RollDamage(
+				Record.GetRollInputs(), RandomStream, bIsCritical, bIsLucky);
+			CalcSeconds += FPlatformTime::Seconds() - CalcStart;
+
+			const double ResolveStart = FPlatformTime::Seconds();
+			float Armor	 = AttributeSet->GetArmor();
+			float Health = AttributeSet->GetHealth();
+			UGGAttributeSet::ResolveIncomingDamage(OutDamage,
+				(Record.Flags & GGCombatRecordFlags::AcidDamage) != 0,
+				(Record.Flags & GGCombatRecordFlags::FireDamage) != 0,
+				AttributeSet->GetArmorMax(), AttributeSet->GetHealthMax(), Armor, Health);
+			AttributeSet->InitArmor(Armor);
+			AttributeSet->InitHealth(Health);
+			ResolveSeconds += FPlatformTime::Seconds() - ResolveStart;
+
+			const bool bRecordedCritical = (Record.Flags & GGCombatRecordFlags::Critical) != 0;
+			const bool bRecordedLucky	 = (Record.Flags & GGCombatRecordFlags::Lucky) != 0;
+			if (!FMath::IsNearlyEqual(OutDamage, Record.OutDamage)
+				|| bIsCritical != bRecordedCritical || bIsLucky != bRecordedLucky)
+			{
+				++Mismatches;
+				if (Loop == 0)
+				{
+					UE_LOG(LogCombatRecorder, Warning,
+						TEXT("[%.3f] %s -> %s (%s): recorded %.2f, replayed %.2f"),
+						Record.WorldTime, *Reader.GetActorName(Record.SourceID),
+						*Reader.GetActorName(Record.TargetID), *Reader.GetEffectName(Record.EffectID),
+						Record.OutDamage, OutDamage);
+				}
+			}
+			else if (bVerbose && Loop == 0)
+			{
+				UE_LOG(LogCombatRecorder, Display, TEXT("[%.3f] %s -> %s: %.2f damage, %.2f armor, %.2f health"),
+					Record.WorldTime, *Reader.GetActorName(Record.SourceID),
+					*Reader.GetActorName(Record.TargetID), OutDamage, Armor, Health);
+			}
+		}
+	}
+
+	const int32 TargetCount = TargetSets.Num();
+	for (const TPair<uint32, UGGAttributeSet*>& Pair : TargetSets)
+	{
+		Pair.Value->RemoveFromRoot();
+	}
+
+	const int64 RecordsPerLoop = RecordCount / Loops;
+	UE_LOG(LogCombatRecorder, Display, TEXT("Replayed %lld damage records (%d loop(s)) against %d targets"),
+		RecordsPerLoop, Loops, TargetCount);
+	UE_LOG(LogCombatRecorder, Display, TEXT("  Damage roll:       %.3f ms total, %.3f us per hit"),
+		CalcSeconds * 1000.0, RecordCount > 0 ? CalcSeconds * 1000000.0 / RecordCount : 0.0);
+	UE_LOG(LogCombatRecorder, Display, TEXT("  Damage resolution: %.3f ms total, %.3f us per hit"),
+		ResolveSeconds * 1000.0, RecordCount > 0 ? ResolveSeconds * 1000000.0 / RecordCount : 0.0);
+	UE_LOG(LogCombatRecorder, Display, TEXT("  Mismatches:        %lld"), Mismatches / Loops);
+
+	return Mismatches > 0 ? 1 : 0;
+}
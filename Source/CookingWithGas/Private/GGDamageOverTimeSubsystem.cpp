@@ -0,0 +1,239 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGDamageOverTimeSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/World.h"
+#include "GameplayEffect.h"
+#include "HAL/IConsoleManager.h"
+
+static float DamageOverTimeInterval = 1.f;
+static FAutoConsoleVariableRef CVarDamageOverTimeInterval(
+	TEXT("gg.DamageOverTime.Interval"), DamageOverTimeInterval,
+	TEXT("Seconds between damage over time ticks, shared by every target."));
+
+// The tick interval, kept above 0 so a bad cvar value can neither divide by zero nor stall the ticks
+static float GetDamageOverTimeInterval()
+{
+	return FMath::Max(DamageOverTimeInterval, 0.01f);
+}
+
+bool UGGDamageOverTimeSubsystem::AddDamageOverTime(AActor* Target, AActor* Instigator, AActor* DamageCauser,
+	FGameplayTag DamageType, float DamagePerTick, float Duration, TSubclassOf<UGameplayEffect> DamageEffect)
+{
+	UWorld* World = Target ? Target->GetWorld() : nullptr;
+	if (!World || World->GetNetMode() == NM_Client || !DamageEffect || DamagePerTick <= 0.f || Duration <= 0.f)
+	{
+		return false;
+	}
+
+	UAbilitySystemComponent* TargetComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target);
+	UGGDamageOverTimeSubsystem* Subsystem = World->GetSubsystem<UGGDamageOverTimeSubsystem>();
+	if (!TargetComponent || !Subsystem)
+	{
+		return false;
+	}
+
+	Subsystem->AddSource(TargetComponent, Instigator, DamageCauser, DamageType, DamagePerTick, Duration, DamageEffect);
+	return true;
+}
+
+void UGGDamageOverTimeSubsystem::ClearDamageOverTime(AActor* Target)
+{
+	UWorld* World = Target ? Target->GetWorld() : nullptr;
+	UGGDamageOverTimeSubsystem* Subsystem = World ? World->GetSubsystem<UGGDamageOverTimeSubsystem>() : nullptr;
+	if (Subsystem)
+	{
+		// Pending expirations for the removed ledger are skipped when they come up
+		Subsystem->Ledgers.Remove(UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target));
+	}
+}
+
+float UGGDamageOverTimeSubsystem::GetDamagePerTick(const AActor* Target)
+{
+	const UWorld* World = Target ? Target->GetWorld() : nullptr;
+	const UGGDamageOverTimeSubsystem* Subsystem = World ? World->GetSubsystem<UGGDamageOverTimeSubsystem>() : nullptr;
+	const FDotLedger* Ledger = Subsystem
+		? Subsystem->Ledgers.Find(UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target))
+		: nullptr;
+
+	float Total = 0.f;
+	if (Ledger)
+	{
+		for (const FDotEntry& Entry : Ledger->Entries)
+		{
+			Total += Entry.DamagePerTick;
+		}
+	}
+	return Total;
+}
+
+bool UGGDamageOverTimeSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UGGDamageOverTimeSubsystem::IsTickable() const
+{
+	return Ledgers.Num() > 0;
+}
+
+TStatId UGGDamageOverTimeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGDamageOverTimeSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Merges the source into the entry for its damage type and instigator, and files its
+ *  expiration under the tick it ends on. The entry takes the effect and causer of the
+ *  latest source, so re-applying with an upgraded effect takes over the merged damage.
+ */
+void UGGDamageOverTimeSubsystem::AddSource(UAbilitySystemComponent* TargetComponent, AActor* Instigator,
+	AActor* DamageCauser, FGameplayTag DamageType, float DamagePerTick, float Duration,
+	TSubclassOf<UGameplayEffect> DamageEffect)
+{
+	if (Ledgers.Num() == 0)
+	{
+		// Nothing was ticking; restart the shared schedule
+		NextTickTime = GetWorld()->GetTimeSeconds() + GetDamageOverTimeInterval();
+	}
+
+	const FObjectKey LedgerKey(TargetComponent);
+	FDotLedger* Ledger = Ledgers.Find(LedgerKey);
+	if (!Ledger)
+	{
+		Ledger = &Ledgers.Add(LedgerKey);
+		Ledger->Target	   = TargetComponent;
+		Ledger->Generation = NextLedgerGeneration++;
+	}
+
+	const FDotEntryKey EntryKey(DamageType, FObjectKey(Instigator));
+	int32 EntryIndex = INDEX_NONE;
+	if (const int32* ExistingIndex = Ledger->EntryIndices.Find(EntryKey))
+	{
+		EntryIndex = *ExistingIndex;
+	}
+	else
+	{
+		FDotEntry NewEntry;
+		NewEntry.Key		  = EntryKey;
+		NewEntry.DamageType	  = DamageType;
+		NewEntry.Instigator	  = Instigator;
+		EntryIndex = Ledger->Entries.Add(MoveTemp(NewEntry));
+		Ledger->EntryIndices.Add(EntryKey, EntryIndex);
+	}
+
+	FDotEntry& Entry = Ledger->Entries[EntryIndex];
+	Entry.DamagePerTick += DamagePerTick;
+	Entry.DamageCauser	 = DamageCauser;
+	Entry.DamageEffect	 = DamageEffect;
+	++Entry.Sources;
+
+	const int64 NumTicks = FMath::Max<int64>(1, FMath::RoundToInt64(Duration / GetDamageOverTimeInterval()));
+	ExpiryBuckets.FindOrAdd(CurrentTick + NumTicks).Add({ LedgerKey, Ledger->Generation, EntryIndex, DamagePerTick });
+}
+
+void UGGDamageOverTimeSubsystem::Tick(float DeltaTime)
+{
+	const double WorldTime = GetWorld()->GetTimeSeconds();
+	while (Ledgers.Num() > 0 && WorldTime >= NextTickTime)
+	{
+		NextTickTime += GetDamageOverTimeInterval();
+		ProcessTick();
+	}
+}
+
+void UGGDamageOverTimeSubsystem::ProcessTick()
+{
+	++CurrentTick;
+
+	// Applying damage can kill targets or add new sources, so gather first and apply after
+	TArray<TPair<TWeakObjectPtr<UAbilitySystemComponent>, FDotEntry>, TInlineAllocator<32>> Applications;
+	for (auto It = Ledgers.CreateIterator(); It; ++It)
+	{
+		if (!It->Value.Target.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		for (const FDotEntry& Entry : It->Value.Entries)
+		{
+			if (Entry.DamagePerTick > 0.f)
+			{
+				Applications.Emplace(It->Value.Target, Entry);
+			}
+		}
+	}
+
+	for (const TPair<TWeakObjectPtr<UAbilitySystemComponent>, FDotEntry>& Application : Applications)
+	{
+		// Skips targets that died, and were cleared, earlier in this tick
+		UAbilitySystemComponent* TargetComponent = Application.Key.Get();
+		if (TargetComponent && Ledgers.Contains(FObjectKey(TargetComponent)))
+		{
+			ApplyEntry(TargetComponent, Application.Value);
+		}
+	}
+
+	TArray<FDotExpiry> Expired;
+	if (ExpiryBuckets.RemoveAndCopyValue(CurrentTick, Expired))
+	{
+		for (const FDotExpiry& Expiry : Expired)
+		{
+			ExpireSource(Expiry);
+		}
+	}
+}
+
+/**
+ *  Applies one tick of merged damage as a single execution of the entry's damage effect.
+ */
+void UGGDamageOverTimeSubsystem::ApplyEntry(UAbilitySystemComponent* TargetComponent, const FDotEntry& Entry) const
+{
+	AActor* Instigator = Entry.Instigator.Get();
+	UAbilitySystemComponent* SourceComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Instigator);
+	UAbilitySystemComponent* SpecComponent = SourceComponent ? SourceComponent : TargetComponent;
+
+	FGameplayEffectContextHandle EffectContext = SpecComponent->MakeEffectContext();
+	EffectContext.AddInstigator(Instigator, Entry.DamageCauser.Get());
+
+	FGameplayEffectSpecHandle SpecHandle = SpecComponent->MakeOutgoingSpec(Entry.DamageEffect, 1, EffectContext);
+	if (!SpecHandle.IsValid())
+	{
+		return;
+	}
+
+	static const FGameplayTag SetByCallerTag = FGameplayTag::RequestGameplayTag(FName("Damage.SetByCaller"), false);
+	SpecHandle.Data->SetSetByCallerMagnitude(SetByCallerTag, Entry.DamagePerTick);
+	if (Entry.DamageType.IsValid())
+	{
+		SpecHandle.Data->AddDynamicAssetTag(Entry.DamageType);
+	}
+
+	SpecComponent->ApplyGameplayEffectSpecToTarget(*SpecHandle.Data.Get(), TargetComponent);
+}
+
+void UGGDamageOverTimeSubsystem::ExpireSource(const FDotExpiry& Expiry)
+{
+	FDotLedger* Ledger = Ledgers.Find(Expiry.LedgerKey);
+	if (!Ledger || Ledger->Generation != Expiry.LedgerGeneration || !Ledger->Entries.IsValidIndex(Expiry.EntryIndex))
+	{
+		return;
+	}
+
+	FDotEntry& Entry = Ledger->Entries[Expiry.EntryIndex];
+	Entry.DamagePerTick -= Expiry.DamagePerTick;
+	if (--Entry.Sources <= 0)
+	{
+		Ledger->EntryIndices.Remove(Entry.Key);
+		Ledger->Entries.RemoveAt(Expiry.EntryIndex);
+	}
+
+	if (Ledger->Entries.Num() == 0)
+	{
+		Ledgers.Remove(Expiry.LedgerKey);
+	}
+}
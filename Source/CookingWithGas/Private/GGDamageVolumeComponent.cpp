@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGDamageVolumeComponent.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameplayEffect.h"
+#include "GGDamageVolumeSubsystem.h"
+
+UGGDamageVolumeComponent::UGGDamageVolumeComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UGGDamageVolumeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Effects are applied by the server only
+	AActor* Owner = GetOwner();
+	if (GetNetMode() == NM_Client || !Owner)
+	{
+		return;
+	}
+
+	Owner->OnActorBeginOverlap.AddDynamic(this, &UGGDamageVolumeComponent::OnOwnerBeginOverlap);
+	Owner->OnActorEndOverlap.AddDynamic(this, &UGGDamageVolumeComponent::OnOwnerEndOverlap);
+
+	// Actors that were already inside before the volume began play
+	TArray<AActor*> OverlappingActors;
+	Owner->GetOverlappingActors(OverlappingActors);
+	for (AActor* Actor : OverlappingActors)
+	{
+		AddOccupant(Actor);
+	}
+}
+
+void UGGDamageVolumeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (AActor* Owner = GetOwner())
+	{
+		Owner->OnActorBeginOverlap.RemoveDynamic(this, &UGGDamageVolumeComponent::OnOwnerBeginOverlap);
+		Owner->OnActorEndOverlap.RemoveDynamic(this, &UGGDamageVolumeComponent::OnOwnerEndOverlap);
+	}
+
+	if (UGGDamageVolumeSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGDamageVolumeSubsystem>())
+	{
+		Subsystem->DeactivateVolume(this);
+	}
+	Occupants.Reset();
+	OccupantIndices.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGGDamageVolumeComponent::OnOwnerBeginOverlap(AActor* OverlappedActor, AActor* OtherActor)
+{
+	AddOccupant(OtherActor);
+}
+
+void UGGDamageVolumeComponent::OnOwnerEndOverlap(AActor* OverlappedActor, AActor* OtherActor)
+{
+	if (const int32* Index = OccupantIndices.Find(OtherActor))
+	{
+		RemoveOccupantAt(*Index);
+	}
+}
+
+void UGGDamageVolumeComponent::GetOccupants(TArray<AActor*>& OutOccupants) const
+{
+	OutOccupants.Reset(Occupants.Num());
+	for (const FOccupant& Occupant : Occupants)
+	{
+		if (AActor* Actor = Occupant.Actor.Get())
+		{
+			OutOccupants.Add(Actor);
+		}
+	}
+}
+
+/**
+ *  Adds the actor to the occupants, waking the volume up if it was empty. Actors without an
+ *  ability system component cannot receive the effect and are ignored.
+ * @param Actor An actor that started overlapping the owner
+ */
+void UGGDamageVolumeComponent::AddOccupant(AActor* Actor)
+{
+	if (!Actor || Actor == GetOwner() || OccupantIndices.Contains(Actor))
+	{
+		return;
+	}
+
+	UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Actor);
+	if (!AbilitySystem)
+	{
+		return;
+	}
+
+	OccupantIndices.Add(Actor, Occupants.Add({ Actor, AbilitySystem, FObjectKey(Actor) }));
+	if (Occupants.Num() == 1)
+	{
+		if (UGGDamageVolumeSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGDamageVolumeSubsystem>())
+		{
+			Subsystem->ActivateVolume(this);
+		}
+	}
+}
+
+void UGGDamageVolumeComponent::RemoveOccupantAt(int32 Index)
+{
+	OccupantIndices.Remove(Occupants[Index].Key);
+	Occupants.RemoveAtSwap(Index, 1, false);
+	if (Occupants.IsValidIndex(Index))
+	{
+		OccupantIndices.Add(Occupants[Index].Key, Index);
+	}
+
+	if (Occupants.Num() == 0)
+	{
+		if (UGGDamageVolumeSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGDamageVolumeSubsystem>())
+		{
+			Subsystem->DeactivateVolume(this);
+		}
+	}
+}
+
+/**
+ *  Builds one spec of the pulse effect and applies it to every occupant. The damage goes
+ *  through the effect's executions, so UGGEffectDamageCalc rolls it per occupant as usual.
+ *  The owner's instigator, if any, is the source and gets credit for the damage.
+ */
+void UGGDamageVolumeComponent::Pulse()
+{
+	if (!PulseEffect)
+	{
+		return;
+	}
+
+	// Applying the effect can kill occupants and end their overlap, so gather first and apply after
+	TArray<TWeakObjectPtr<UAbilitySystemComponent>, TInlineAllocator<16>> Targets;
+	for (int32 Index = Occupants.Num() - 1; Index >= 0; --Index)
+	{
+		if (UAbilitySystemComponent* AbilitySystem = Occupants[Index].AbilitySystem.Get())
+		{
+			Targets.Add(AbilitySystem);
+		}
+		else
+		{
+			RemoveOccupantAt(Index);
+		}
+	}
+	if (Targets.Num() == 0)
+	{
+		return;
+	}
+
+	AActor* Instigator = GetOwner()->GetInstigator();
+	UAbilitySystemComponent* SourceComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Instigator);
+
+	FGameplayEffectContextHandle EffectContext = SourceComponent
+		? SourceComponent->MakeEffectContext()
+		: FGameplayEffectContextHandle(UAbilitySystemGlobals::Get().AllocGameplayEffectContext());
+	EffectContext.AddInstigator(Instigator, GetOwner());
+
+	FGameplayEffectSpec Spec(PulseEffect->GetDefaultObject<UGameplayEffect>(), EffectContext, EffectLevel);
+	if (DamagePerPulse > 0.f)
+	{
+		static const FGameplayTag SetByCallerTag = FGameplayTag::RequestGameplayTag(FName("Damage.SetByCaller"), false);
+		Spec.SetSetByCallerMagnitude(SetByCallerTag, DamagePerPulse);
+	}
+	if (DamageTypeTag.IsValid())
+	{
+		Spec.AddDynamicAssetTag(DamageTypeTag);
+	}
+
+	for (const TWeakObjectPtr<UAbilitySystemComponent>& TargetPtr : Targets)
+	{
+		UAbilitySystemComponent* Target = TargetPtr.Get();
+		if (!Target)
+		{
+			continue;
+		}
+
+		if (SourceComponent)
+		{
+			SourceComponent->ApplyGameplayEffectSpecToTarget(Spec, Target);
+		}
+		else
+		{
+			Target->ApplyGameplayEffectSpecToSelf(Spec);
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGDamageVolumeSubsystem.h"
+#include "Engine/World.h"
+#include "GGDamageVolumeComponent.h"
+
+/**
+ *  Adds the volume to the pulsed ones. Its first pulse lands on the next multiple of its
+ *  interval, so every volume with the same interval pulses in the same frame.
+ * @param Volume A volume that just got its first occupant
+ */
+void UGGDamageVolumeSubsystem::ActivateVolume(UGGDamageVolumeComponent* Volume)
+{
+	if (!Volume || ActiveVolumes.Contains(Volume))
+	{
+		return;
+	}
+
+	const double Interval = FMath::Max(Volume->PulseInterval, 0.05f);
+	Volume->NextPulseTime = FMath::CeilToDouble(GetWorld()->GetTimeSeconds() / Interval) * Interval;
+	ActiveVolumes.Add(Volume);
+}
+
+void UGGDamageVolumeSubsystem::DeactivateVolume(UGGDamageVolumeComponent* Volume)
+{
+	ActiveVolumes.RemoveSingleSwap(Volume, false);
+}
+
+bool UGGDamageVolumeSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UGGDamageVolumeSubsystem::IsTickable() const
+{
+	return ActiveVolumes.Num() > 0;
+}
+
+TStatId UGGDamageVolumeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGDamageVolumeSubsystem, STATGROUP_Tickables);
+}
+
+void UGGDamageVolumeSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Pulses can remove occupants and deactivate volumes, so gather first and pulse after
+	const double Now = GetWorld()->GetTimeSeconds();
+	TArray<TWeakObjectPtr<UGGDamageVolumeComponent>, TInlineAllocator<16>> DueVolumes;
+	for (int32 Index = ActiveVolumes.Num() - 1; Index >= 0; --Index)
+	{
+		UGGDamageVolumeComponent* Volume = ActiveVolumes[Index].Get();
+		if (!Volume)
+		{
+			ActiveVolumes.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (Now >= Volume->NextPulseTime)
+		{
+			// After a hitch, skip the missed pulses rather than firing them all at once
+			const double Interval = FMath::Max(Volume->PulseInterval, 0.05f);
+			Volume->NextPulseTime = FMath::Max(Volume->NextPulseTime + Interval, (FMath::FloorToDouble(Now / Interval) + 1.0) * Interval);
+			DueVolumes.Add(Volume);
+		}
+	}
+
+	for (const TWeakObjectPtr<UGGDamageVolumeComponent>& Volume : DueVolumes)
+	{
+		if (Volume.IsValid())
+		{
+			Volume->Pulse();
+		}
+	}
+}
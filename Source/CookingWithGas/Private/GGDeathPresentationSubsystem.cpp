@@ -0,0 +1,289 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGDeathPresentationSubsystem.h"
+#include "Animation/AnimationAsset.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GGCharacterBase.h"
+#include "GGEnemyCharacter.h"
+#include "HAL/IConsoleManager.h"
+
+static int32 DeathMaxRagdolls = 8;
+static FAutoConsoleVariableRef CVarDeathMaxRagdolls(
+	TEXT("gg.Death.MaxRagdolls"), DeathMaxRagdolls,
+	TEXT("Most ragdolls simulating at once. Deaths beyond it play a baked death animation."));
+
+static float DeathMaxRagdollTime = 5.f;
+static FAutoConsoleVariableRef CVarDeathMaxRagdollTime(
+	TEXT("gg.Death.MaxRagdollTime"), DeathMaxRagdollTime,
+	TEXT("Seconds a ragdoll may simulate before it is frozen, settled or not."));
+
+static float DeathSettleSpeed = 5.f;
+static FAutoConsoleVariableRef CVarDeathSettleSpeed(
+	TEXT("gg.Death.SettleSpeed"), DeathSettleSpeed,
+	TEXT("Speed under which a ragdoll counts as settled, in world units per second."));
+
+static float DeathSettleTime = 0.5f;
+static FAutoConsoleVariableRef CVarDeathSettleTime(
+	TEXT("gg.Death.SettleTime"), DeathSettleTime,
+	TEXT("Seconds a ragdoll has to stay settled before it is frozen into a static pose."));
+
+static int32 DeathMaxCorpses = 32;
+static FAutoConsoleVariableRef CVarDeathMaxCorpses(
+	TEXT("gg.Death.MaxCorpses"), DeathMaxCorpses,
+	TEXT("Most corpses kept in the world; the oldest are removed first."));
+
+static float DeathCorpseLifetime = 60.f;
+static FAutoConsoleVariableRef CVarDeathCorpseLifetime(
+	TEXT("gg.Death.CorpseLifetime"), DeathCorpseLifetime,
+	TEXT("Seconds before a corpse is removed; 0 or less to keep corpses until the cap is reached."));
+
+bool UGGDeathPresentationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UGGDeathPresentationSubsystem::ShouldPresent() const
+{
+	return GetWorld()->GetNetMode() != NM_DedicatedServer;
+}
+
+/**
+ *  Drops the character onto the floor below it, keeping only its yaw, and turns off what a
+ *  corpse no longer needs: movement, capsule collision and movement replication.
+ * @param Character The character that just died
+ * @return The pose to replicate to clients
+ */
+FGGDeathRestingPose UGGDeathPresentationSubsystem::MakeRestingPose(AGGCharacterBase* Character)
+{
+	FGGDeathRestingPose Pose;
+	Pose.bIsDead = true;
+	Pose.Location = Character->GetActorLocation();
+	Pose.Yaw = Character->GetActorRotation().Yaw;
+
+	UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	const float HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GGDeathRestingPose), false, Character);
+	FHitResult Hit;
+	if (Character->GetWorld()->LineTraceSingleByChannel(Hit, Pose.Location,
+		Pose.Location - FVector(0.f, 0.f, HalfHeight + 500.f), ECC_Visibility, QueryParams))
+	{
+		Pose.Location = Hit.ImpactPoint + FVector(0.f, 0.f, HalfHeight);
+	}
+
+	if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+	{
+		Movement->StopMovementImmediately();
+		Movement->DisableMovement();
+	}
+	Capsule->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Character->SetReplicateMovement(false);
+	Character->SetActorLocationAndRotation(Pose.Location, FRotator(0.f, Pose.Yaw, 0.f));
+	return Pose;
+}
+
+void UGGDeathPresentationSubsystem::HandleDeath(AGGCharacterBase* Character)
+{
+	if (!Character || Corpses.ContainsByPredicate([Character](const FCorpse& Corpse) { return Corpse.Character == Character; }))
+	{
+		return;
+	}
+
+	Character->SetActorTickEnabled(false);
+
+	// Only enemies become corpses that get culled; player characters belong to the game mode
+	// and must never be destroyed here, even while still possessed
+	if (Character->IsA<AGGEnemyCharacter>())
+	{
+		Corpses.Add({ Character, GetWorld()->GetTimeSeconds() });
+	}
+
+	if (ShouldPresent())
+	{
+		if (ActiveRagdolls.Num() < DeathMaxRagdolls)
+		{
+			StartRagdoll(Character);
+		}
+		else
+		{
+			PlayDeathAnimation(Character);
+		}
+	}
+
+	// Make room right away rather than on the next tick
+	CullCorpses(GetWorld()->GetTimeSeconds());
+}
+
+void UGGDeathPresentationSubsystem::StartRagdoll(AGGCharacterBase* Character)
+{
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if (!Mesh || !Mesh->GetPhysicsAsset())
+	{
+		PlayDeathAnimation(Character);
+		return;
+	}
+
+	Mesh->SetCollisionProfileName(TEXT("Ragdoll"));
+	Mesh->SetAllBodiesSimulatePhysics(true);
+	Mesh->SetSimulatePhysics(true);
+	Mesh->WakeAllRigidBodies();
+
+	FRagdoll& Ragdoll = ActiveRagdolls.AddDefaulted_GetRef();
+	Ragdoll.Character = Character;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UGGDeathPresentationSubsystem::PlayDeathAnimation(AGGCharacterBase* Character)
+{
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if (!Mesh)
+	{
+		return;
+	}
+
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	if (Character->DeathAnimations.Num() > 0)
+	{
+		// Holds the last frame once done
+		UAnimationAsset* DeathAnimation = Character->DeathAnimations[FMath::RandHelper(Character->DeathAnimations.Num())];
+		Mesh->PlayAnimation(DeathAnimation, false);
+	}
+}
+
+/**
+ *  Stops simulating the ragdoll and keeps its current pose: with physics off and the mesh no
+ *  longer ticking, the bones stay where the simulation left them.
+ * @param Character The character whose ragdoll is settled
+ */
+void UGGDeathPresentationSubsystem::FreezeRagdoll(AGGCharacterBase* Character)
+{
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if (!Mesh)
+	{
+		return;
+	}
+
+	Mesh->SetAllBodiesSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->bNoSkeletonUpdate = true;
+	Mesh->SetComponentTickEnabled(false);
+}
+
+/**
+ *  Destroys the corpse on the server. Clients hide it meanwhile, so their own cap holds even
+ *  before the destruction reaches them.
+ * @param Character The corpse, or null if it is already gone
+ */
+void UGGDeathPresentationSubsystem::RemoveCorpse(AGGCharacterBase* Character)
+{
+	if (!Character)
+	{
+		return;
+	}
+
+	ActiveRagdolls.RemoveAllSwap([Character](const FRagdoll& Ragdoll) { return Ragdoll.Character == Character; }, false);
+
+	if (Character->HasAuthority())
+	{
+		Character->Destroy();
+	}
+	else
+	{
+		Character->SetActorHiddenInGame(true);
+		if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+		{
+			Mesh->SetAllBodiesSimulatePhysics(false);
+			Mesh->SetComponentTickEnabled(false);
+		}
+	}
+}
+
+bool UGGDeathPresentationSubsystem::IsTickable() const
+{
+	return ActiveRagdolls.Num() > 0 || Corpses.Num() > 0;
+}
+
+TStatId UGGDeathPresentationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGDeathPresentationSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Freezes the ragdolls that have settled or run out of time, then removes expired corpses.
+ * @param DeltaTime Unused; settling and lifetimes are measured on world time
+ */
+void UGGDeathPresentationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float SettleSpeedSquared = FMath::Square(DeathSettleSpeed);
+
+	for (int32 Index = ActiveRagdolls.Num() - 1; Index >= 0; --Index)
+	{
+		FRagdoll& Ragdoll = ActiveRagdolls[Index];
+		AGGCharacterBase* Character = Ragdoll.Character.Get();
+		USkeletalMeshComponent* Mesh = Character ? Character->GetMesh() : nullptr;
+		if (!Mesh)
+		{
+			ActiveRagdolls.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (Mesh->GetPhysicsLinearVelocity().SizeSquared() > SettleSpeedSquared)
+		{
+			Ragdoll.SettledSince = 0.0;
+		}
+		else if (Ragdoll.SettledSince == 0.0)
+		{
+			Ragdoll.SettledSince = Now;
+		}
+
+		const bool bSettled = Ragdoll.SettledSince > 0.0 && Now - Ragdoll.SettledSince >= DeathSettleTime;
+		if (bSettled || Now - Ragdoll.StartTime >= DeathMaxRagdollTime)
+		{
+			FreezeRagdoll(Character);
+			ActiveRagdolls.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	CullCorpses(Now);
+}
+
+/**
+ *  Removes corpses that are gone or past gg.Death.CorpseLifetime, and the oldest ones beyond
+ *  gg.Death.MaxCorpses. A corpse whose deferred OnOutOfHealth event has not run yet is skipped
+ *  and culled on a later tick, so the score, drops or kill credit given there are never lost.
+ * @param Now The current world time
+ */
+void UGGDeathPresentationSubsystem::CullCorpses(double Now)
+{
+	const int32 MaxCorpses = FMath::Max(DeathMaxCorpses, 1);
+	int32 Index = 0;
+	while (Index < Corpses.Num())
+	{
+		const FCorpse& Corpse = Corpses[Index];
+		AGGCharacterBase* Character = Corpse.Character.Get();
+		const bool bExpired = !Character || (DeathCorpseLifetime > 0.f && Now - Corpse.DeathTime >= DeathCorpseLifetime);
+
+		// Corpses are sorted by death time, so once one is neither expired nor over the cap, none after it is
+		if (!bExpired && Corpses.Num() <= MaxCorpses)
+		{
+			break;
+		}
+
+		if (Character && Character->IsDeathEventPending())
+		{
+			++Index;
+			continue;
+		}
+
+		RemoveCorpse(Character);
+		Corpses.RemoveAt(Index, 1, false);
+	}
+}
@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGDeferredWorkSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY(LogDeferredWork);
+
+static float DeferredWorkBudgetMs = 0.5f;
+static FAutoConsoleVariableRef CVarDeferredWorkBudgetMs(
+	TEXT("gg.DeferredWork.BudgetMs"), DeferredWorkBudgetMs,
+	TEXT("Time allowed for deferred work each frame, in milliseconds. At least one item runs every frame."));
+
+static float DeferredWorkMaxWaitMsHigh = 50.f;
+static FAutoConsoleVariableRef CVarDeferredWorkMaxWaitMsHigh(
+	TEXT("gg.DeferredWork.MaxWaitMs.High"), DeferredWorkMaxWaitMsHigh,
+	TEXT("How long high priority work may wait before it runs regardless of the budget, in milliseconds."));
+
+static float DeferredWorkMaxWaitMsNormal = 250.f;
+static FAutoConsoleVariableRef CVarDeferredWorkMaxWaitMsNormal(
+	TEXT("gg.DeferredWork.MaxWaitMs.Normal"), DeferredWorkMaxWaitMsNormal,
+	TEXT("How long normal priority work may wait before it runs regardless of the budget, in milliseconds."));
+
+static float DeferredWorkMaxWaitMsLow = 1000.f;
+static FAutoConsoleVariableRef CVarDeferredWorkMaxWaitMsLow(
+	TEXT("gg.DeferredWork.MaxWaitMs.Low"), DeferredWorkMaxWaitMsLow,
+	TEXT("How long low priority work may wait before it runs regardless of the budget, in milliseconds."));
+
+static bool bDeferredWorkEnabled = true;
+static FAutoConsoleVariableRef CVarDeferredWorkEnabled(
+	TEXT("gg.DeferredWork.Enabled"), bDeferredWorkEnabled,
+	TEXT("If false, submitted work runs right away instead of being queued."));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdDeferredWorkStats(
+	TEXT("gg.DeferredWork.Stats"),
+	TEXT("Lists the depth, throughput and latency of each deferred work queue."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UGGDeferredWorkSubsystem* Subsystem = UGGDeferredWorkSubsystem::Get(World))
+		{
+			Subsystem->LogStats(Ar);
+		}
+	}));
+
+UGGDeferredWorkSubsystem* UGGDeferredWorkSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine
+		? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull)
+		: nullptr;
+	return World ? World->GetSubsystem<UGGDeferredWorkSubsystem>() : nullptr;
+}
+
+void UGGDeferredWorkSubsystem::Submit(const UObject* WorldContextObject, EGGDeferredWorkPriority Priority,
+	const UObject* Owner, TUniqueFunction<void()>&& Work)
+{
+	UGGDeferredWorkSubsystem* Subsystem = bDeferredWorkEnabled ? Get(WorldContextObject) : nullptr;
+	if (!Subsystem || Priority >= EGGDeferredWorkPriority::MAX)
+	{
+		if (!Owner || IsValid(Owner))
+		{
+			Work();
+		}
+		return;
+	}
+
+	FWorkQueue& Queue = Subsystem->Queues[static_cast<int32>(Priority)];
+
+	FWorkItem& Item	 = Queue.Items.AddDefaulted_GetRef();
+	Item.Work		 = MoveTemp(Work);
+	Item.Owner		 = Owner;
+	Item.bHasOwner	 = Owner != nullptr;
+	Item.SubmitTime	 = FPlatformTime::Seconds();
+
+	++Queue.Submitted;
+	Queue.PeakDepth = FMath::Max(Queue.PeakDepth, Queue.Num());
+}
+
+void UGGDeferredWorkSubsystem::SubmitDeferredWork(const UObject* WorldContextObject,
+	EGGDeferredWorkPriority Priority, FGGDeferredWorkDelegate Work)
+{
+	const UObject* Owner = Work.GetUObject();
+	Submit(WorldContextObject, Priority, Owner, [Work]()
+	{
+		Work.ExecuteIfBound();
+	});
+}
+
+int32 UGGDeferredWorkSubsystem::GetQueueDepth(EGGDeferredWorkPriority Priority) const
+{
+	return Priority < EGGDeferredWorkPriority::MAX ? Queues[static_cast<int32>(Priority)].Num() : 0;
+}
+
+double UGGDeferredWorkSubsystem::GetMaxWait(int32 PriorityIndex)
+{
+	switch (static_cast<EGGDeferredWorkPriority>(PriorityIndex))
+	{
+	case EGGDeferredWorkPriority::High:		return DeferredWorkMaxWaitMsHigh / 1000.0;
+	case EGGDeferredWorkPriority::Normal:	return DeferredWorkMaxWaitMsNormal / 1000.0;
+	default:								return DeferredWorkMaxWaitMsLow / 1000.0;
+	}
+}
+
+bool UGGDeferredWorkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGGDeferredWorkSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldBeginTearDownHandle = FWorldDelegates::OnWorldBeginTearDown.AddUObject(this, &UGGDeferredWorkSubsystem::OnWorldBeginTearDown);
+}
+
+void UGGDeferredWorkSubsystem::OnWorldBeginTearDown(UWorld* World)
+{
+	// Actors are still alive at this point, so queued work such as default effects is not lost
+	if (World == GetWorld())
+	{
+		Flush();
+	}
+}
+
+void UGGDeferredWorkSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldBeginTearDown.Remove(WorldBeginTearDownHandle);
+
+	// Only work submitted after the teardown flush is left; the actors it was meant for are gone
+	for (int32 PriorityIndex = 0; PriorityIndex < UE_ARRAY_COUNT(Queues); ++PriorityIndex)
+	{
+		if (Queues[PriorityIndex].Num() > 0)
+		{
+			UE_LOG(LogDeferredWork, Verbose, TEXT("Dropping %d deferred work items of priority %s"),
+				Queues[PriorityIndex].Num(), *UEnum::GetValueAsString(static_cast<EGGDeferredWorkPriority>(PriorityIndex)));
+		}
+		Queues[PriorityIndex] = FWorkQueue();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UGGDeferredWorkSubsystem::IsTickable() const
+{
+	for (const FWorkQueue& Queue : Queues)
+	{
+		if (Queue.Num() > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TStatId UGGDeferredWorkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGDeferredWorkSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  First runs every item that has waited past the max wait of its priority, then runs
+ *  items in priority order until the budget is spent. At least one item runs each frame.
+ * @param DeltaTime Unused; the budget and waits are measured in real time
+ */
+void UGGDeferredWorkSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double FrameStart = FPlatformTime::Seconds();
+	const double BudgetEnd	= FrameStart + DeferredWorkBudgetMs / 1000.0;
+	bool bRanAny = false;
+
+	// Overdue items only wait behind each other, never behind the budget
+	for (int32 PriorityIndex = 0; PriorityIndex < UE_ARRAY_COUNT(Queues); ++PriorityIndex)
+	{
+		const double OverdueBefore = FrameStart - GetMaxWait(PriorityIndex);
+		FWorkQueue& Queue = Queues[PriorityIndex];
+		while (Queue.Num() > 0 && Queue.Items[Queue.Head].SubmitTime <= OverdueBefore)
+		{
+			RunNext(PriorityIndex, FPlatformTime::Seconds(), true);
+			bRanAny = true;
+		}
+	}
+
+	for (int32 PriorityIndex = 0; PriorityIndex < UE_ARRAY_COUNT(Queues); ++PriorityIndex)
+	{
+		FWorkQueue& Queue = Queues[PriorityIndex];
+		while (Queue.Num() > 0)
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (bRanAny && Now >= BudgetEnd)
+			{
+				break;
+			}
+			RunNext(PriorityIndex, Now, false);
+			bRanAny = true;
+		}
+	}
+
+	// Drop the items that have run once they make up half the queue
+	for (FWorkQueue& Queue : Queues)
+	{
+		if (Queue.Num() == 0)
+		{
+			Queue.Items.Reset();
+			Queue.Head = 0;
+		}
+		else if (Queue.Head > 0 && Queue.Head >= Queue.Items.Num() / 2)
+		{
+			Queue.Items.RemoveAt(0, Queue.Head, false);
+			Queue.Head = 0;
+		}
+	}
+}
+
+void UGGDeferredWorkSubsystem::RunNext(int32 PriorityIndex, double Now, bool bOverdue)
+{
+	FWorkQueue& Queue = Queues[PriorityIndex];
+
+	// Moved out first; the work may submit more work to the same queue
+	FWorkItem Item = MoveTemp(Queue.Items[Queue.Head]);
+	++Queue.Head;
+
+	if (Item.bHasOwner && !Item.Owner.IsValid())
+	{
+		++Queue.Dropped;
+		return;
+	}
+
+	const double Latency = Now - Item.SubmitTime;
+	++Queue.Executed;
+	Queue.Overdue	   += bOverdue ? 1 : 0;
+	Queue.TotalLatency += Latency;
+	Queue.MaxLatency	= FMath::Max(Queue.MaxLatency, Latency);
+
+	Item.Work();
+}
+
+/**
+ *  Runs every queued item, highest priority first. Work may submit more work, possibly of a
+ *  higher priority, so the queues are visited again from the top after each item.
+ */
+void UGGDeferredWorkSubsystem::Flush()
+{
+	int32 PriorityIndex = 0;
+	while (PriorityIndex < UE_ARRAY_COUNT(Queues))
+	{
+		if (Queues[PriorityIndex].Num() > 0)
+		{
+			RunNext(PriorityIndex, FPlatformTime::Seconds(), false);
+			PriorityIndex = 0;
+		}
+		else
+		{
+			++PriorityIndex;
+		}
+	}
+
+	for (FWorkQueue& Queue : Queues)
+	{
+		Queue.Items.Reset();
+		Queue.Head = 0;
+	}
+}
+
+void UGGDeferredWorkSubsystem::LogStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Deferred work, budget %.2f ms per frame:"), DeferredWorkBudgetMs);
+	for (int32 PriorityIndex = 0; PriorityIndex < UE_ARRAY_COUNT(Queues); ++PriorityIndex)
+	{
+		const FWorkQueue& Queue = Queues[PriorityIndex];
+		const double AverageLatency = Queue.Executed > 0 ? Queue.TotalLatency / Queue.Executed : 0.0;
+		Ar.Logf(TEXT("  %-8s depth %5d (peak %5d)  submitted %7lld  executed %7lld  dropped %5lld  overdue %5lld  latency avg %7.2f ms, max %7.2f ms (max wait %.0f ms)"),
+			*UEnum::GetDisplayValueAsText(static_cast<EGGDeferredWorkPriority>(PriorityIndex)).ToString(),
+			Queue.Num(), Queue.PeakDepth, Queue.Submitted, Queue.Executed, Queue.Dropped, Queue.Overdue,
+			AverageLatency * 1000.0, Queue.MaxLatency * 1000.0, GetMaxWait(PriorityIndex) * 1000.0);
+	}
+}
@@ -3,7 +3,9 @@
 
 #include "GGDestructible.h"
 #include "AbilitySystemComponent.h"
+#include "GGAbilitySystemComponent.h"
 #include "GGAttributeSet.h"
+#include "GGDeferredWorkSubsystem.h"
 
 
 // Sets default values
@@ -14,7 +16,7 @@ AGGDestructible::AGGDestructible()
 	StaticMeshComp->SetCollisionObjectType(ECC_PhysicsBody);
 	SetRootComponent(StaticMeshComp);
 
-	AbilitySystemComponent = CreateDefaultSubobject<UAbilitySystemComponent>("AbilitySystem");
+	AbilitySystemComponent = CreateDefaultSubobject<UGGAbilitySystemComponent>("AbilitySystem");
 	AbilitySystemComponent->SetIsReplicated(true);
 	AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
 
@@ -46,5 +48,17 @@ void AGGDestructible::BeginPlay()
 
 void AGGDestructible::OnHealthAttributeChanged(const FOnAttributeChangeData& Data)
 {
-	OnHealthChanged(Data.OldValue, Data.NewValue);
+	if (Data.NewValue > 0.f || Data.OldValue <= 0.f)
+	{
+		OnHealthChanged(Data.OldValue, Data.NewValue);
+		return;
+	}
+
+	// Running out of health tears the destructible down; an explosion can break many at once,
+	// so the teardown is spread over the next frames
+	UGGDeferredWorkSubsystem::Submit(this, EGGDeferredWorkPriority::Normal, this,
+		[this, OldValue = Data.OldValue, NewValue = Data.NewValue]()
+	{
+		OnHealthChanged(OldValue, NewValue);
+	});
 }
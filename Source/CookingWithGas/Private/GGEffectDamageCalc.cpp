@@ -2,8 +2,13 @@
 
 
 #include "GGEffectDamageCalc.h"
+#include "GGAbilitySystemComponent.h"
 #include "GGAttributeSet.h"
+#include "GGCharacterBase.h"
+#include "GGCombatRecorder.h"
 #include "GGGameplayEffectContext.h"
+#include "GGHitZoneData.h"
+#include "GGLagCompensationSubsystem.h"
 
 #include "Logging/StructuredLog.h"
 
@@ -62,52 +67,119 @@ void UGGEffectDamageCalc::Execute_Implementation(const FGameplayEffectCustomExec
 	
 	ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
 		DamageStatics().InDamageDef, EvaluationParameters, InDamage);
-	
-	float CriticalChance	 = 0.f;
-	float CriticalMultiplier = 0.f;
-	float LuckyChance		 = 0.f;
 
-	// Set critical chance to 100% if the hit bone is the head
-	ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
-		DamageStatics().CriticalChanceDef, EvaluationParameters, CriticalChance);
-	const FHitResult* HitResult = EffectSpec.GetContext().GetHitResult();
-	if (HitResult)
+	// The Damage.Type tag of the hit picks the offense snapshot, so type specific buffs apply
+	static const FGameplayTag DamageTypeTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type"), false);
+	FGameplayTag DamageType;
+	if (SourceTags)
 	{
-		if (HitResult->BoneName == "head")
+		for (const FGameplayTag& Tag : *SourceTags)
 		{
-			CriticalChance = 100.f;
+			if (Tag != DamageTypeTag && Tag.MatchesTag(DamageTypeTag))
+			{
+				DamageType = Tag;
+				break;
+			}
 		}
 	}
 
-	// Multiply the damage if the hit was a critical hit
-	ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
-		DamageStatics().CriticalMultiplierDef, EvaluationParameters, CriticalMultiplier);
-	
-	bool isCritical = FMath::RandRange(0.01f, 100.f) <= CriticalChance;
-	if (CriticalMultiplier > 1.f)
+	FGGDamageRollInputs RollInputs;
+	float DamageAdd	  = 0.f;
+	float DamageMulti = 1.f;
+	if (UGGAbilitySystemComponent* GGSourceComponent = Cast<UGGAbilitySystemComponent>(SourceComponent))
+	{
+		// Evaluated once per damage type and target tags, and reused until a buff or attribute changes
+		const FGGOffenseSnapshot& Offense = GGSourceComponent->GetOffenseSnapshot(DamageType, TargetTags);
+		RollInputs.CriticalChance	  = Offense.CriticalChance;
+		RollInputs.CriticalMultiplier = Offense.CriticalMultiplier;
+		RollInputs.LuckyChance		  = Offense.LuckyChance;
+		DamageAdd					  = Offense.DamageAdd;
+		DamageMulti					  = Offense.DamageMulti;
+	}
+	else
 	{
-		InDamage *= isCritical ? CriticalMultiplier : 1.f;
+		ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
+			DamageStatics().CriticalChanceDef, EvaluationParameters, RollInputs.CriticalChance);
+		ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
+			DamageStatics().CriticalMultiplierDef, EvaluationParameters, RollInputs.CriticalMultiplier);
+		ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
+			DamageStatics().LuckyChanceDef, EvaluationParameters, RollInputs.LuckyChance);
+		if (IsValid(SourceComponent) && SourceComponent->GetSet<UGGAttributeSet>())
+		{
+			DamageAdd	= SourceComponent->GetNumericAttribute(UGGAttributeSet::GetDamageAddAttribute());
+			DamageMulti	= SourceComponent->GetNumericAttribute(UGGAttributeSet::GetDamageMultiAttribute());
+		}
 	}
 
-	// For every time the random number is below the lucky chance,
-	//	the damage multiplier will be increased by *1 and the lucky chance
-	//	gets lowered by 100%
-	ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(
-		DamageStatics().LuckyChanceDef, EvaluationParameters, LuckyChance);
+	// Flat bonus first, then the multiplier
+	InDamage = (InDamage + DamageAdd) * DamageMulti;
 
-	bool isLucky = false;
-	if (LuckyChance > 0.f)
+	// Explosions scale their damage by distance (see UGGExplosionSubsystem)
+	static const FGameplayTag FalloffTag = FGameplayTag::RequestGameplayTag(FName("Damage.Falloff"), false);
+	InDamage *= EffectSpec.GetSetByCallerMagnitude(FalloffTag, false, 1.f);
+	RollInputs.InDamage = InDamage;
+
+	// The hit bone picks a zone of the target's hit zone table with one indexed lookup;
+	// targets without a table only treat the head as special
+	const FHitResult* HitResult = EffectSpec.GetContext().GetHitResult();
+	const AGGCharacterBase* TargetCharacter = Cast<AGGCharacterBase>(TargetActor);
+	uint8 HitZoneId = 0;
+	if (HitResult && TargetCharacter && TargetCharacter->HitZones)
 	{
-		float LuckyMulti = 1.f;
-		
-		while (FMath::RandRange(0.01f, 100.f) <= LuckyChance)
+		HitZoneId = TargetCharacter->GetHitZoneId(HitResult->BoneName);
+	}
+	else
+	{
+		RollInputs.bIsHeadshot = HitResult && HitResult->BoneName == "head";
+	}
+
+	// A claimed bone or zone is checked against the present and, for hits the shooter's client
+	// reported, also where the target was when the shooter fired; the better result counts.
+	// Only the upgrade is rejected when neither matches: the hit still deals base damage.
+	const FGGGameplayEffectContext* GGContext = static_cast<const FGGGameplayEffectContext*>(EffectSpec.GetContext().Get());
+	const bool bClientReported = GGContext && GGContext->HasHitViewDelay();
+	const UGGLagCompensationSubsystem* LagCompensation = UGGLagCompensationSubsystem::Get(TargetActor);
+	if (HitResult && LagCompensation && (RollInputs.bIsHeadshot || HitZoneId != 0))
+	{
+		const double Now = TargetActor->GetWorld()->GetTimeSeconds();
+		EGGHitValidation Validation = LagCompensation->ValidateHit(TargetActor, *HitResult, Now);
+		if (bClientReported && (Validation == EGGHitValidation::Miss || Validation == EGGHitValidation::Body))
 		{
-			LuckyChance -= 100.f;
-			LuckyMulti  += 1.f;
-			isLucky		 = true;
+			Validation = FMath::Max(Validation,
+				LagCompensation->ValidateHit(TargetActor, *HitResult, Now - GGContext->GetHitViewDelay()));
+		}
+		if (Validation == EGGHitValidation::Body || Validation == EGGHitValidation::Miss)
+		{
+			UE_LOGFMT(LogTemp, Verbose, "Rejected the {Bone} claim of a hit on {Target}; applying base damage",
+				HitResult->BoneName, GetNameSafe(TargetActor));
+			RollInputs.bIsHeadshot = false;
+			HitZoneId = 0;
 		}
-		
-		InDamage *= isLucky ? LuckyMulti : 1.f;
+	}
+
+	// Folded into the roll inputs, so recorded rolls replay without the table
+	if (const FGGHitZone* HitZone = HitZoneId != 0 ? TargetCharacter->HitZones->GetZone(HitZoneId) : nullptr)
+	{
+		RollInputs.InDamage *= HitZone->DamageMultiplier;
+		if (HitZone->bOverrideCriticalChance)
+		{
+			RollInputs.CriticalChance = HitZone->CriticalChance;
+		}
+	}
+
+	// Every roll gets its own seed so it can be recorded and replayed exactly
+	const int32 RandomSeed = FMath::Rand();
+	FRandomStream RandomStream(RandomSeed);
+
+	bool isCritical = false;
+	bool isLucky	= false;
+	InDamage = RollDamage(RollInputs, RandomStream, isCritical, isLucky);
+
+	UGGCombatRecorder* CombatRecorder = UGGCombatRecorder::Get(TargetComponent);
+	if (CombatRecorder && CombatRecorder->IsRecording())
+	{
+		CombatRecorder->RecordDamage(SourceComponent, TargetComponent, EffectSpec,
+			RollInputs, RandomSeed, isCritical, isLucky, InDamage);
 	}
 
 	UE_LOGFMT(LogTemp, Log, "Damage After Modification: {DamageValue}", InDamage);
@@ -122,5 +194,50 @@ void UGGEffectDamageCalc::Execute_Implementation(const FGameplayEffectCustomExec
 	{
 		EffectContext->SetIsCriticalHit(isCritical);
 		EffectContext->SetIsLuckyHit(isLucky);
+		EffectContext->SetHitZone(HitZoneId);
+	}
+}
+
+/**
+ *  Applies the critical and lucky hit rules to the incoming damage.
+ * @param Inputs The captured magnitudes the roll is based on
+ * @param RandomStream The stream used for every random roll, by reference
+ * @param bOutIsCritical True if the hit was rolled as a critical hit
+ * @param bOutIsLucky True if the hit was rolled as a lucky hit
+ * @return The damage after critical and lucky multipliers have been applied
+ */
+float UGGEffectDamageCalc::RollDamage(const FGGDamageRollInputs& Inputs, FRandomStream& RandomStream,
+                                      bool& bOutIsCritical, bool& bOutIsLucky)
+{
+	float InDamage = Inputs.InDamage;
+
+	// Set critical chance to 100% if the hit bone is the head
+	const float CriticalChance = Inputs.bIsHeadshot ? 100.f : Inputs.CriticalChance;
+
+	// Multiply the damage if the hit was a critical hit
+	bOutIsCritical = RandomStream.FRandRange(0.01f, 100.f) <= CriticalChance;
+	if (Inputs.CriticalMultiplier > 1.f)
+	{
+		InDamage *= bOutIsCritical ? Inputs.CriticalMultiplier : 1.f;
+	}
+
+	// For every time the random number is below the lucky chance,
+	//	the damage multiplier will be increased by *1 and the lucky chance
+	//	gets lowered by 100%
+	float LuckyChance = Inputs.LuckyChance;
+	bOutIsLucky = false;
+	if (LuckyChance > 0.f)
+	{
+		float LuckyMulti = 1.f;
+		
+		while (RandomStream.FRandRange(0.01f, 100.f) <= LuckyChance)
+		{
+			LuckyChance -= 100.f;
+			LuckyMulti  += 1.f;
+			bOutIsLucky	 = true;
+		}
+		
+		InDamage *= bOutIsLucky ? LuckyMulti : 1.f;
 	}
+	return InDamage;
 }
@@ -4,7 +4,9 @@
 #include "GGEnemyCharacter.h"
 
 #include "AbilitySystemComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "GGAttributeSet.h"
+#include "GGMovementLODSubsystem.h"
 
 // Sets default values
 AGGEnemyCharacter::AGGEnemyCharacter()
@@ -28,11 +30,109 @@ void AGGEnemyCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
+	ThreatTable.SetDecay(ThreatHalfLife, MinThreat, GetWorld()->GetTimeSeconds());
+
 	// Sets up "OnArmorAttributeChanged" to be called whenever the CHILLED
 	// attribute changes within the AbilitySystemComponent
 	AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(
 		AttributeSet->GetChilledAttribute()).AddUObject(
 			this, &AGGEnemyCharacter::OnChilledAttributeChanged);
 
+	if (HasAuthority())
+	{
+		if (UGGMovementLODSubsystem* MovementLOD = GetWorld()->GetSubsystem<UGGMovementLODSubsystem>())
+		{
+			MovementLOD->RegisterEnemy(this);
+		}
+	}
+}
+
+void AGGEnemyCharacter::OnDamageTakenChanged(AActor* DamageInstigator, AActor* DamageCauser,
+	const FGameplayTagContainer& DamageTags, float DamageMagnitude, bool isCritical, bool isLucky)
+{
+	Super::OnDamageTakenChanged(DamageInstigator, DamageCauser, DamageTags, DamageMagnitude, isCritical, isLucky);
+	EnterCombat();
+
+	// Clients replay hits through here too; threat is only kept on the server
+	if (HasAuthority() && DamageInstigator != this)
+	{
+		AddThreat(DamageInstigator, DamageMagnitude);
+	}
+}
+
+AActor* AGGEnemyCharacter::GetTopThreat() const
+{
+	return ThreatTable.GetTopThreat(GetWorld()->GetTimeSeconds());
+}
+
+float AGGEnemyCharacter::GetThreat(const AActor* Instigator) const
+{
+	return ThreatTable.GetThreat(Instigator, GetWorld()->GetTimeSeconds());
+}
+
+void AGGEnemyCharacter::AddThreat(AActor* Instigator, float Threat)
+{
+	if (HasAuthority())
+	{
+		ThreatTable.AddThreat(Instigator, Threat, GetWorld()->GetTimeSeconds());
+	}
+}
+
+void AGGEnemyCharacter::ClearThreat()
+{
+	ThreatTable.Reset();
+}
+
+void AGGEnemyCharacter::EnterCombat()
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	LastCombatTime = GetWorld()->GetTimeSeconds();
+	SetMovementLOD(false);
+}
+
+/**
+ *  Switches between full and low detail movement. Low detail swaps walking for navmesh
+ *  walking, which follows the navmesh instead of sweeping for the floor, and lowers the
+ *  movement tick rate and net update frequency. Only enemies that are walking switch to low
+ *  detail, so jumps and falls always finish with full detail.
+ * @param bLowDetail True for low detail movement
+ */
+void AGGEnemyCharacter::SetMovementLOD(bool bLowDetail)
+{
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	if (bMovementLOD == bLowDetail || !Movement)
+	{
+		return;
+	}
+
+	if (bLowDetail)
+	{
+		if (Movement->MovementMode != MOVE_Walking)
+		{
+			return;
+		}
+
+		FullDetailNetUpdateFrequency = NetUpdateFrequency;
+		Movement->SetMovementMode(MOVE_NavWalking);
+		Movement->SetComponentTickInterval(MovementLODTickInterval);
+		NetUpdateFrequency = FMath::Min(NetUpdateFrequency, MovementLODNetUpdateFrequency);
+	}
+	else
+	{
+		// Walking finds the floor again on its first update
+		if (Movement->MovementMode == MOVE_NavWalking)
+		{
+			Movement->SetMovementMode(MOVE_Walking);
+		}
+		Movement->SetComponentTickInterval(0.f);
+		NetUpdateFrequency = FullDetailNetUpdateFrequency;
+		ForceNetUpdate();
+	}
+
+	bMovementLOD = bLowDetail;
 }
 
@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGExplosionSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogExplosion);
+
+static int32 ExplosionTracesPerFrame = 64;
+static FAutoConsoleVariableRef CVarExplosionTracesPerFrame(
+	TEXT("gg.Explosion.TracesPerFrame"), ExplosionTracesPerFrame,
+	TEXT("Maximum number of explosion line of sight traces issued per frame."));
+
+bool UGGExplosionSubsystem::Explode(const UObject* WorldContextObject, const FGGExplosionParams& Params)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		return false;
+	}
+
+	UGGExplosionSubsystem* Subsystem = World->GetSubsystem<UGGExplosionSubsystem>();
+	return Subsystem && Subsystem->AddExplosion(Params);
+}
+
+/**
+ *  Full damage inside the inner radius, then falls off towards MinDamageScale at the outer radius.
+ * @param Params The explosion being resolved
+ * @param Distance Distance from the explosion origin to the victim
+ * @return The multiplier for the explosion damage
+ */
+float UGGExplosionSubsystem::GetDamageScale(const FGGExplosionParams& Params, float Distance)
+{
+	if (Distance <= Params.InnerRadius || Params.Radius <= Params.InnerRadius)
+	{
+		return 1.f;
+	}
+
+	const float Alpha = FMath::Clamp((Distance - Params.InnerRadius) / (Params.Radius - Params.InnerRadius), 0.f, 1.f);
+	return FMath::Lerp(1.f, Params.MinDamageScale, FMath::Pow(Alpha, Params.FalloffExponent));
+}
+
+bool UGGExplosionSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UGGExplosionSubsystem::IsTickable() const
+{
+	return QueuedTraceHead < QueuedTraces.Num();
+}
+
+TStatId UGGExplosionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGExplosionSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Gathers every ability system actor in the radius and queues a trace for each one,
+ *  nearest first. Ties are broken by unique ID so the order never depends on the overlap.
+ */
+bool UGGExplosionSubsystem::AddExplosion(const FGGExplosionParams& Params)
+{
+	UWorld* World = GetWorld();
+	if (!Params.DamageSpec.IsValid() || Params.Radius <= 0.f)
+	{
+		return false;
+	}
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByObjectType(Overlaps, Params.Origin, FQuat::Identity, ObjectParams,
+		FCollisionShape::MakeSphere(Params.Radius));
+
+	struct FCandidate
+	{
+		AActor* Actor;
+		float DistanceSquared;
+	};
+	TArray<FCandidate, TInlineAllocator<32>> Candidates;
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* Actor = Overlap.GetActor();
+		if (!Actor || Candidates.ContainsByPredicate([Actor](const FCandidate& C) { return C.Actor == Actor; }))
+		{
+			continue;
+		}
+
+		if (UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Actor))
+		{
+			Candidates.Add({ Actor, FVector::DistSquared(Params.Origin, Actor->GetActorLocation()) });
+		}
+	}
+
+	if (Candidates.Num() == 0)
+	{
+		return true;
+	}
+
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B)
+	{
+		return A.DistanceSquared != B.DistanceSquared
+			? A.DistanceSquared < B.DistanceSquared
+			: A.Actor->GetUniqueID() < B.Actor->GetUniqueID();
+	});
+
+	const uint32 ExplosionID = NextExplosionID++;
+	FPendingExplosion& Explosion = Explosions.Add(ExplosionID);
+	Explosion.Params = Params;
+	Explosion.TracesRemaining = Candidates.Num();
+	Explosion.Victims.Reserve(Candidates.Num());
+	Explosion.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(ExplosionOcclusion), false);
+	Explosion.QueryParams.AddIgnoredActor(Params.DamageCauser);
+	Explosion.QueryParams.AddIgnoredActor(Params.DamageSpec.Data->GetContext().GetInstigator());
+
+	for (const FCandidate& Candidate : Candidates)
+	{
+		QueuedTraces.Add({ ExplosionID, Explosion.Victims.Num() });
+		Explosion.Victims.Add(Candidate.Actor);
+		Explosion.QueryParams.AddIgnoredActor(Candidate.Actor);
+	}
+	return true;
+}
+
+/**
+ *  Issues queued traces, up to the per-frame budget.
+ */
+void UGGExplosionSubsystem::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	if (!TraceDelegate.IsBound())
+	{
+		TraceDelegate.BindUObject(this, &UGGExplosionSubsystem::OnTraceCompleted);
+	}
+
+	int32 Budget = FMath::Max(ExplosionTracesPerFrame, 1);
+	while (Budget > 0 && QueuedTraceHead < QueuedTraces.Num())
+	{
+		const FPendingTrace Trace = QueuedTraces[QueuedTraceHead++];
+		FPendingExplosion* Explosion = Explosions.Find(Trace.ExplosionID);
+		AActor* Victim = Explosion ? Explosion->Victims[Trace.VictimIndex].Get() : nullptr;
+		if (!Victim)
+		{
+			FinishTrace(Trace.ExplosionID);
+			continue;
+		}
+
+		const uint32 TraceIndex = InFlightTraces.Add(Trace);
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Explosion->Params.Origin,
+			Victim->GetActorLocation(), Explosion->Params.OcclusionChannel, Explosion->QueryParams,
+			FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceIndex);
+		--Budget;
+	}
+
+	if (QueuedTraceHead >= QueuedTraces.Num())
+	{
+		QueuedTraces.Reset();
+		QueuedTraceHead = 0;
+	}
+}
+
+void UGGExplosionSubsystem::OnTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const int32 TraceIndex = static_cast<int32>(TraceDatum.UserData);
+	if (!InFlightTraces.IsValidIndex(TraceIndex))
+	{
+		return;
+	}
+
+	const FPendingTrace Trace = InFlightTraces[TraceIndex];
+	InFlightTraces.RemoveAt(TraceIndex);
+
+	if (const FPendingExplosion* Explosion = Explosions.Find(Trace.ExplosionID))
+	{
+		AActor* Victim = Explosion->Victims[Trace.VictimIndex].Get();
+		const FHitResult* Blocker = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Hit)
+		{
+			return Hit.bBlockingHit;
+		});
+
+		if (Victim && !Blocker)
+		{
+			ApplyDamage(*Explosion, Victim);
+		}
+		else if (Victim)
+		{
+			UE_LOG(LogExplosion, Verbose, TEXT("%s is shielded from explosion %u by %s"),
+				*GetNameSafe(Victim), Trace.ExplosionID, *GetNameSafe(Blocker->GetActor()));
+		}
+	}
+
+	FinishTrace(Trace.ExplosionID);
+}
+
+/**
+ *  Applies a copy of the explosion spec to the victim, scaled by distance. The damage
+ *  goes through the effect's executions, so UGGEffectDamageCalc rolls it as usual.
+ */
+void UGGExplosionSubsystem::ApplyDamage(const FPendingExplosion& Explosion, AActor* Victim) const
+{
+	UAbilitySystemComponent* TargetComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Victim);
+	if (!TargetComponent)
+	{
+		return;
+	}
+
+	const FGameplayEffectSpec& BaseSpec = *Explosion.Params.DamageSpec.Data.Get();
+	const float Distance = FVector::Dist(Explosion.Params.Origin, Victim->GetActorLocation());
+
+	FGameplayEffectSpec VictimSpec(BaseSpec);
+	static const FGameplayTag FalloffTag = FGameplayTag::RequestGameplayTag(FName("Damage.Falloff"), false);
+	VictimSpec.SetSetByCallerMagnitude(FalloffTag, GetDamageScale(Explosion.Params, Distance));
+
+	if (UAbilitySystemComponent* SourceComponent = BaseSpec.GetContext().GetInstigatorAbilitySystemComponent())
+	{
+		SourceComponent->ApplyGameplayEffectSpecToTarget(VictimSpec, TargetComponent);
+	}
+	else
+	{
+		TargetComponent->ApplyGameplayEffectSpecToSelf(VictimSpec);
+	}
+}
+
+void UGGExplosionSubsystem::FinishTrace(uint32 ExplosionID)
+{
+	FPendingExplosion* Explosion = Explosions.Find(ExplosionID);
+	if (Explosion && --Explosion->TracesRemaining <= 0)
+	{
+		Explosions.Remove(ExplosionID);
+	}
+}
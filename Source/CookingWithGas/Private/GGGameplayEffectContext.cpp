@@ -23,7 +23,8 @@ FGGGameplayEffectContext* FGGGameplayEffectContext::Duplicate() const
 
 bool FGGGameplayEffectContext::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
 {
-	uint8 RepBits = 0;
+	// Ten flags, so they no longer fit in a byte
+	uint16 RepBits = 0;
 	if (Ar.IsSaving())
 	{
 		if (bReplicateInstigator && Instigator.IsValid())
@@ -62,9 +63,13 @@ bool FGGGameplayEffectContext::NetSerialize(FArchive& Ar, UPackageMap* Map, bool
 		{
 			RepBits |= 1 << 8;
 		}
+		if (HitZone != 0)
+		{
+			RepBits |= 1 << 9;
+		}
 	}
 
-	Ar.SerializeBits(&RepBits, 9);
+	Ar.SerializeBits(&RepBits, 10);
 
 	if (RepBits & (1 << 0))
 	{
@@ -114,6 +119,14 @@ bool FGGGameplayEffectContext::NetSerialize(FArchive& Ar, UPackageMap* Map, bool
 	{
 		Ar << bIsLuckyHit;
 	}
+	if (RepBits & (1 << 9))
+	{
+		Ar << HitZone;
+	}
+	else
+	{
+		HitZone = 0;
+	}
 
 	if (Ar.IsLoading())
 	{
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGHitFeedbackSubsystem.h"
+#include "Engine/World.h"
+#include "GameplayEffect.h"
+#include "GGCharacterBase.h"
+#include "GGGameplayEffectContext.h"
+#include "HAL/IConsoleManager.h"
+
+static bool bHitFeedbackBatching = true;
+static FAutoConsoleVariableRef CVarHitFeedbackBatching(
+	TEXT("gg.HitFeedback.Batching"), bHitFeedbackBatching,
+	TEXT("Sends hit feedback to clients as one multicast per frame."));
+
+static int32 HitFeedbackMaxEventsPerRPC = 64;
+static FAutoConsoleVariableRef CVarHitFeedbackMaxEventsPerRPC(
+	TEXT("gg.HitFeedback.MaxEventsPerRPC"), HitFeedbackMaxEventsPerRPC,
+	TEXT("Most hits packed into one multicast; busier frames send several. Capped at 255."));
+
+// Bits of the flags byte written before each event
+namespace GGHitFeedbackFlags
+{
+	enum : uint8
+	{
+		Critical		= 1 << 0,
+		Lucky			= 1 << 1,
+		HasInstigator	= 1 << 2,
+		HasDamageType	= 1 << 3,
+		HasHitZone		= 1 << 4,
+	};
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FGGHitFeedbackBatch
+
+bool FGGHitFeedbackBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	const auto GetFlags = [](const FGGHitFeedbackEvent& Event) -> uint8
+	{
+		uint8 Flags = 0;
+		Flags |= Event.bIsCritical				? GGHitFeedbackFlags::Critical		: 0;
+		Flags |= Event.bIsLucky					? GGHitFeedbackFlags::Lucky			: 0;
+		Flags |= Event.Instigator.IsValid()		? GGHitFeedbackFlags::HasInstigator	: 0;
+		Flags |= Event.DamageType.IsValid()		? GGHitFeedbackFlags::HasDamageType	: 0;
+		Flags |= Event.HitZone != 0				? GGHitFeedbackFlags::HasHitZone	: 0;
+		return Flags;
+	};
+
+	bOutSuccess = TGGEventBatcher<FGGHitFeedbackBatch>::NetSerializeEvents(Ar, Events, GetFlags,
+		[&Ar, Map](FGGHitFeedbackEvent& Event, uint8 Flags)
+	{
+		Event.bIsCritical = (Flags & GGHitFeedbackFlags::Critical) != 0;
+		Event.bIsLucky	  = (Flags & GGHitFeedbackFlags::Lucky) != 0;
+
+		UObject* Target = Event.Target.Get();
+		Map->SerializeObject(Ar, AActor::StaticClass(), Target);
+		Event.Target = Cast<AActor>(Target);
+
+		if (Flags & GGHitFeedbackFlags::HasInstigator)
+		{
+			UObject* Instigator = Event.Instigator.Get();
+			Map->SerializeObject(Ar, AActor::StaticClass(), Instigator);
+			Event.Instigator = Cast<AActor>(Instigator);
+		}
+
+		bool bLocationSuccess = true;
+		Event.Location.NetSerialize(Ar, Map, bLocationSuccess);
+
+		FFloat16 Magnitude(Event.Magnitude);
+		Ar << Magnitude.Encoded;
+		Event.Magnitude = Magnitude;
+
+		bool bTagSuccess = true;
+		if (Flags & GGHitFeedbackFlags::HasDamageType)
+		{
+			Event.DamageType.NetSerialize(Ar, Map, bTagSuccess);
+		}
+
+		if (Flags & GGHitFeedbackFlags::HasHitZone)
+		{
+			Ar << Event.HitZone;
+		}
+		else
+		{
+			Event.HitZone = 0;
+		}
+
+		return bLocationSuccess && bTagSuccess;
+	});
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// AGGHitFeedbackReplicator
+
+void AGGHitFeedbackReplicator::MulticastHitFeedback_Implementation(const FGGHitFeedbackBatch& Batch)
+{
+	// The server already fired these events when the damage was applied
+	if (GetNetMode() != NM_Client)
+	{
+		return;
+	}
+
+	for (const FGGHitFeedbackEvent& Event : Batch.Events)
+	{
+		if (AGGCharacterBase* Character = Cast<AGGCharacterBase>(Event.Target.Get()))
+		{
+			Character->ReceiveHitFeedback(Event);
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UGGHitFeedbackSubsystem
+
+UGGHitFeedbackSubsystem::UGGHitFeedbackSubsystem()
+{
+	ReplicatorClass = AGGHitFeedbackReplicator::StaticClass();
+}
+
+/**
+ *  Records where and in which zone the hit landed and, on a server with clients, queues it
+ *  for this frame's batch.
+ * @param Target The actor that took the damage; only characters have hit feedback
+ * @param DamageSpec The damage effect spec, for its context and damage type
+ * @param Magnitude The damage dealt
+ */
+void UGGHitFeedbackSubsystem::AddHit(AActor* Target, const FGameplayEffectSpec& DamageSpec, float Magnitude)
+{
+	AGGCharacterBase* Character = Cast<AGGCharacterBase>(Target);
+	UWorld* World = Character ? Character->GetWorld() : nullptr;
+	if (!World)
+	{
+		return;
+	}
+
+	const FGameplayEffectContextHandle& ContextHandle = DamageSpec.GetEffectContext();
+	const FHitResult* HitResult = ContextHandle.GetHitResult();
+	Character->LastDamageLocation = HitResult ? FVector(HitResult->ImpactPoint) : Character->GetActorLocation();
+
+	const FGGGameplayEffectContext* EffectContext = static_cast<const FGGGameplayEffectContext*>(ContextHandle.Get());
+	Character->LastDamageHitZone = EffectContext ? EffectContext->GetHitZone() : 0;
+
+	const ENetMode NetMode = World->GetNetMode();
+	UGGHitFeedbackSubsystem* Subsystem = World->GetSubsystem<UGGHitFeedbackSubsystem>();
+	if (!bHitFeedbackBatching || NetMode == NM_Standalone || NetMode == NM_Client || !Subsystem)
+	{
+		return;
+	}
+
+	FGGHitFeedbackEvent& Event = Subsystem->PendingEvents.Add();
+	Event.Target	 = Character;
+	Event.Instigator = ContextHandle.GetOriginalInstigator();
+	Event.Location	 = Character->LastDamageLocation;
+	Event.Magnitude	 = Magnitude;
+	Event.HitZone	 = Character->LastDamageHitZone;
+
+	if (EffectContext)
+	{
+		Event.bIsCritical = EffectContext->IsCriticalHit();
+		Event.bIsLucky	  = EffectContext->IsLuckyHit();
+	}
+
+	static const FGameplayTag DamageTypeTag = FGameplayTag::RequestGameplayTag(FName("Damage.Type"), false);
+	for (const FGameplayTag& Tag : DamageSpec.CapturedSourceTags.GetSpecTags())
+	{
+		if (Tag != DamageTypeTag && Tag.MatchesTag(DamageTypeTag))
+		{
+			Event.DamageType = Tag;
+			break;
+		}
+	}
+}
+
+bool UGGHitFeedbackSubsystem::IsTickable() const
+{
+	return PendingEvents.HasPendingEvents();
+}
+
+TStatId UGGHitFeedbackSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGHitFeedbackSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Sends every hit queued this frame. Subsystems tick after actors, so the batch holds all
+ *  the damage applied during the frame.
+ * @param DeltaTime Unused
+ */
+void UGGHitFeedbackSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	AGGHitFeedbackReplicator* Replicator = GetReplicator<AGGHitFeedbackReplicator>();
+	if (!Replicator)
+	{
+		PendingEvents.Reset();
+		return;
+	}
+
+	FGGHitFeedbackBatch Batch;
+	PendingEvents.SendBatches(Batch, HitFeedbackMaxEventsPerRPC, [Replicator](const FGGHitFeedbackBatch& InBatch)
+	{
+		Replicator->MulticastHitFeedback(InBatch);
+	});
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGHitZoneData.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Misc/DataValidation.h"
+
+#define LOCTEXT_NAMESPACE "GGHitZoneData"
+
+/**
+ *  Resolves the zones against the bones of the mesh. Bones listed by a zone get its ID;
+ *  every other bone takes the ID of its parent, so a zone covers the bones below it.
+ * @param Mesh The mesh of the character being registered
+ * @return The zone ID of each bone, by bone index; null without a mesh
+ */
+TSharedPtr<const TArray<uint8>> UGGHitZoneData::GetBoneZones(const USkeletalMesh* Mesh) const
+{
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+
+	if (const TSharedPtr<const TArray<uint8>>* Cached = BoneZonesByMesh.Find(Mesh))
+	{
+		return *Cached;
+	}
+
+	const FReferenceSkeleton& RefSkeleton = Mesh->GetRefSkeleton();
+	TArray<uint8> ListedZones;
+	ListedZones.SetNumZeroed(RefSkeleton.GetNum());
+
+	const int32 NumZones = FMath::Min(Zones.Num(), 255);
+	for (int32 ZoneIndex = 0; ZoneIndex < NumZones; ++ZoneIndex)
+	{
+		for (const FName& BoneName : Zones[ZoneIndex].Bones)
+		{
+			const int32 BoneIndex = RefSkeleton.FindBoneIndex(BoneName);
+			if (BoneIndex != INDEX_NONE)
+			{
+				ListedZones[BoneIndex] = static_cast<uint8>(ZoneIndex + 1);
+			}
+		}
+	}
+
+	// Parents always come before their children in the reference skeleton
+	TSharedRef<TArray<uint8>> BoneZones = MakeShared<TArray<uint8>>();
+	BoneZones->SetNumZeroed(RefSkeleton.GetNum());
+	for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetNum(); ++BoneIndex)
+	{
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		(*BoneZones)[BoneIndex] = ListedZones[BoneIndex] != 0 || ParentIndex == INDEX_NONE
+			? ListedZones[BoneIndex]
+			: (*BoneZones)[ParentIndex];
+	}
+
+	BoneZonesByMesh.Add(Mesh, BoneZones);
+	return BoneZones;
+}
+
+FPrimaryAssetId UGGHitZoneData::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(FPrimaryAssetType("HitZones"), GetFName());
+}
+
+#if WITH_EDITOR
+void UGGHitZoneData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Characters registered after this pick up the edited zones
+	BoneZonesByMesh.Reset();
+}
+#endif
+
+#if WITH_EDITOR
+/**
+ *  Checks that the zones fit in a one byte ID, and that every bone they list is in the skeleton.
+ * @param Context Receives the errors
+ * @return Invalid if a zone cannot be resolved as authored
+ */
+EDataValidationResult UGGHitZoneData::IsDataValid(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = CombineDataValidationResults(Super::IsDataValid(Context), EDataValidationResult::Valid);
+
+	if (Zones.Num() > 255)
+	{
+		Context.AddError(FText::Format(LOCTEXT("TooManyZones", "{0} zones, but at most 255 are supported"),
+			FText::AsNumber(Zones.Num())));
+		Result = EDataValidationResult::Invalid;
+	}
+
+	if (!Skeleton)
+	{
+		return Result;
+	}
+
+	const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+	for (const FGGHitZone& Zone : Zones)
+	{
+		for (const FName& BoneName : Zone.Bones)
+		{
+			if (RefSkeleton.FindBoneIndex(BoneName) == INDEX_NONE)
+			{
+				Context.AddError(FText::Format(LOCTEXT("UnknownBone", "Zone {0} lists bone {1}, which is not in {2}"),
+					FText::FromName(Zone.ZoneName), FText::FromName(BoneName), FText::FromString(Skeleton->GetName())));
+				Result = EDataValidationResult::Invalid;
+			}
+		}
+	}
+
+	return Result;
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,257 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGLagCompensationSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerState.h"
+#include "GGCharacterBase.h"
+#include "GGGameplayEffectContext.h"
+#include "HAL/IConsoleManager.h"
+
+static float LagCompensationMaxRewindMs = 400.f;
+static FAutoConsoleVariableRef CVarLagCompensationMaxRewindMs(
+	TEXT("gg.LagCompensation.MaxRewindMs"), LagCompensationMaxRewindMs,
+	TEXT("Furthest back a hit is rewound, in milliseconds. Shooters with more latency are checked at this age."));
+
+static float LagCompensationInterpDelayMs = 100.f;
+static FAutoConsoleVariableRef CVarLagCompensationInterpDelayMs(
+	TEXT("gg.LagCompensation.InterpDelayMs"), LagCompensationInterpDelayMs,
+	TEXT("How far behind the latest replicated state clients show other characters, in milliseconds."));
+
+static int32 LagCompensationHistorySize = 64;
+static FAutoConsoleVariableRef CVarLagCompensationHistorySize(
+	TEXT("gg.LagCompensation.HistorySize"), LagCompensationHistorySize,
+	TEXT("Samples kept per character, one per server tick. Read when the first character registers."));
+
+static float LagCompensationTolerance = 10.f;
+static FAutoConsoleVariableRef CVarLagCompensationTolerance(
+	TEXT("gg.LagCompensation.Tolerance"), LagCompensationTolerance,
+	TEXT("Extra distance allowed around the rewound capsule and bones, in world units."));
+
+UGGLagCompensationSubsystem* UGGLagCompensationSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine
+		? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull)
+		: nullptr;
+	return World ? World->GetSubsystem<UGGLagCompensationSubsystem>() : nullptr;
+}
+
+bool UGGLagCompensationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGGLagCompensationSubsystem::RegisterCharacter(AGGCharacterBase* Character)
+{
+	if (!Character || !Character->HasAuthority() || HistoryIndices.Contains(Character))
+	{
+		return;
+	}
+
+	if (Capacity == 0)
+	{
+		Capacity = FMath::Max(LagCompensationHistorySize, 2);
+	}
+
+	const int32 HistoryIndex = Histories.AddDefaulted();
+	HistoryIndices.Add(Character, HistoryIndex);
+
+	FRewindHistory& History = Histories[HistoryIndex];
+	History.Character = Character;
+	History.Key = Character;
+	History.CapsuleRadius = Character->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	History.CapsuleHalfHeight = Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	for (const FGGRewindBone& Bone : Character->RewindBones)
+	{
+		if (Mesh && Mesh->GetBoneIndex(Bone.BoneName) != INDEX_NONE)
+		{
+			History.BoneNames.Add(Bone.BoneName);
+			History.BoneRadii.Add(Bone.Radius);
+		}
+	}
+
+	// Servers skip the pose of meshes nobody renders, which would leave the bones where they were
+	if (Mesh && History.BoneNames.Num() > 0)
+	{
+		Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	}
+
+	History.Times.SetNumZeroed(Capacity);
+	History.CapsuleLocations.SetNumZeroed(Capacity);
+	History.BoneLocations.SetNumZeroed(Capacity * History.BoneNames.Num());
+}
+
+bool UGGLagCompensationSubsystem::IsTickable() const
+{
+	return Histories.Num() > 0;
+}
+
+TStatId UGGLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Samples every character once per server tick and forgets the ones that are gone.
+ * @param DeltaTime Unused; samples are stamped with world time
+ */
+void UGGLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float Now = static_cast<float>(GetWorld()->GetTimeSeconds());
+	for (int32 HistoryIndex = Histories.Num() - 1; HistoryIndex >= 0; --HistoryIndex)
+	{
+		if (Histories[HistoryIndex].Character.IsValid())
+		{
+			Sample(Histories[HistoryIndex], Now);
+			continue;
+		}
+
+		// The last history moves into the freed slot; it has already been sampled this tick
+		const int32 LastIndex = Histories.Num() - 1;
+		HistoryIndices.Remove(Histories[HistoryIndex].Key);
+		if (HistoryIndex != LastIndex)
+		{
+			HistoryIndices[Histories[LastIndex].Key] = HistoryIndex;
+		}
+		Histories.RemoveAtSwap(HistoryIndex, 1, false);
+	}
+}
+
+void UGGLagCompensationSubsystem::Sample(FRewindHistory& History, float Time) const
+{
+	const AGGCharacterBase* Character = History.Character.Get();
+
+	History.Newest = (History.Newest + 1) % Capacity;
+	History.Count = FMath::Min(History.Count + 1, Capacity);
+
+	History.Times[History.Newest] = Time;
+	History.CapsuleLocations[History.Newest] = FVector3f(Character->GetActorLocation());
+
+	const USkeletalMeshComponent* Mesh = Character->GetMesh();
+	const int32 NumBones = History.BoneNames.Num();
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex)
+	{
+		History.BoneLocations[History.Newest * NumBones + BoneIndex] =
+			FVector3f(Mesh->GetSocketLocation(History.BoneNames[BoneIndex]));
+	}
+}
+
+bool UGGLagCompensationSubsystem::FindSamples(const FRewindHistory& History, float Time,
+	int32& OutOlder, int32& OutNewer, float& OutAlpha) const
+{
+	if (History.Count == 0)
+	{
+		return false;
+	}
+
+	// Walk back from the newest sample; rewinds are short, so this stops within a few samples
+	OutNewer = History.Newest;
+	OutOlder = History.Newest;
+	OutAlpha = 0.f;
+	for (int32 Step = 1; Step < History.Count; ++Step)
+	{
+		if (History.Times[OutNewer] <= Time)
+		{
+			break;
+		}
+		OutOlder = (OutNewer - 1 + Capacity) % Capacity;
+		if (History.Times[OutOlder] <= Time)
+		{
+			const float Span = History.Times[OutNewer] - History.Times[OutOlder];
+			OutAlpha = Span > UE_KINDA_SMALL_NUMBER ? (Time - History.Times[OutOlder]) / Span : 0.f;
+			return true;
+		}
+		OutNewer = OutOlder;
+	}
+
+	// Before the oldest sample or after the newest one: use the sample at that end
+	OutOlder = OutNewer;
+	return true;
+}
+
+/**
+ *  Rewinds the target to the view time and checks the impact point against its capsule,
+ *  then against the claimed bone if the hit names one of the target's rewind bones.
+ * @param Target The actor that was hit
+ * @param Hit The hit to check
+ * @param ViewTime World time the shooter saw; clamped to gg.LagCompensation.MaxRewindMs ago
+ * @return How much of the hit holds up
+ */
+EGGHitValidation UGGLagCompensationSubsystem::ValidateHit(const AActor* Target, const FHitResult& Hit, double ViewTime) const
+{
+	const int32* HistoryIndex = Target ? HistoryIndices.Find(Target) : nullptr;
+	if (!HistoryIndex)
+	{
+		return EGGHitValidation::NotTracked;
+	}
+
+	const FRewindHistory& History = Histories[*HistoryIndex];
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float Time = static_cast<float>(FMath::Clamp(ViewTime, Now - LagCompensationMaxRewindMs / 1000.0, Now));
+
+	int32 Older, Newer;
+	float Alpha;
+	if (!FindSamples(History, Time, Older, Newer, Alpha))
+	{
+		return EGGHitValidation::NotTracked;
+	}
+
+	// Cheap test first: distance from the capsule's segment
+	const FVector3f Impact = FVector3f(Hit.ImpactPoint);
+	const FVector3f Capsule = FMath::Lerp(History.CapsuleLocations[Older], History.CapsuleLocations[Newer], Alpha);
+	const float SegmentHalfLength = FMath::Max(History.CapsuleHalfHeight - History.CapsuleRadius, 0.f);
+	const FVector3f ClosestOnSegment(Capsule.X, Capsule.Y,
+		FMath::Clamp(Impact.Z, Capsule.Z - SegmentHalfLength, Capsule.Z + SegmentHalfLength));
+	if (FVector3f::DistSquared(Impact, ClosestOnSegment) > FMath::Square(History.CapsuleRadius + LagCompensationTolerance))
+	{
+		return EGGHitValidation::Miss;
+	}
+
+	if (Hit.BoneName.IsNone())
+	{
+		return EGGHitValidation::Body;
+	}
+
+	const int32 BoneIndex = History.BoneNames.IndexOfByKey(Hit.BoneName);
+	if (BoneIndex == INDEX_NONE)
+	{
+		return EGGHitValidation::BoneNotTracked;
+	}
+
+	const int32 NumBones = History.BoneNames.Num();
+	const FVector3f Bone = FMath::Lerp(History.BoneLocations[Older * NumBones + BoneIndex],
+		History.BoneLocations[Newer * NumBones + BoneIndex], Alpha);
+	return FVector3f::DistSquared(Impact, Bone) <= FMath::Square(History.BoneRadii[BoneIndex] + LagCompensationTolerance)
+		? EGGHitValidation::Bone
+		: EGGHitValidation::Body;
+}
+
+float UGGLagCompensationSubsystem::GetShooterViewDelay(const AActor* Shooter) const
+{
+	const APawn* Pawn = Cast<APawn>(Shooter);
+	const APlayerState* PlayerState = Pawn ? Pawn->GetPlayerState() : nullptr;
+	if (!PlayerState || Pawn->IsLocallyControlled())
+	{
+		return 0.f;
+	}
+
+	// A client sees others a round trip plus its interpolation delay behind the server
+	const float RewindMs = PlayerState->GetPingInMilliseconds() + LagCompensationInterpDelayMs;
+	return FMath::Min(RewindMs, LagCompensationMaxRewindMs) / 1000.f;
+}
+
+void UGGLagCompensationSubsystem::MarkClientReportedHit(FGameplayEffectContextHandle& Context, const AActor* Shooter) const
+{
+	if (FGGGameplayEffectContext* GGContext = static_cast<FGGGameplayEffectContext*>(Context.Get()))
+	{
+		GGContext->SetHitViewDelay(GetShooterViewDelay(Shooter));
+	}
+}
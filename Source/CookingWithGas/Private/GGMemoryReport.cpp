@@ -0,0 +1,341 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGMemoryReport.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemInterface.h"
+#include "Camera/CameraComponent.h"
+#include "EngineUtils.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "GGAbilitySystemComponent.h"
+#include "GGCharacterBase.h"
+#include "GGDestructible.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY(LogMemoryReport);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdMemoryReport(
+	TEXT("gg.MemoryReport"),
+	TEXT("Reports the memory of every character and destructible, per class and in total.\n")
+	TEXT("Arguments: Actors to also list every actor, CSV[=<path>] to write a snapshot."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World)
+		{
+			return;
+		}
+
+		bool bPerActor = false;
+		bool bWriteCSV = false;
+		FString CSVPath;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.Equals(TEXT("Actors"), ESearchCase::IgnoreCase))
+			{
+				bPerActor = true;
+			}
+			else if (Arg.StartsWith(TEXT("CSV"), ESearchCase::IgnoreCase))
+			{
+				bWriteCSV = true;
+				Arg.Split(TEXT("="), nullptr, &CSVPath);
+			}
+		}
+
+		const FGGMemoryReport Report = FGGMemoryReport::Gather(World);
+		Report.Log(Ar, bPerActor);
+
+		if (bWriteCSV)
+		{
+			if (CSVPath.IsEmpty())
+			{
+				CSVPath = FGGMemoryReport::GetDefaultCSVPath(World);
+			}
+			if (Report.WriteCSV(CSVPath))
+			{
+				Ar.Logf(TEXT("Memory report written to %s"), *CSVPath);
+			}
+		}
+	}));
+
+//////////////////////////////////////////////////////////////////////////
+// FGGActorMemoryFootprint
+
+uint64 FGGActorMemoryFootprint::GetTotal() const
+{
+	uint64 Total = 0;
+	for (const uint64 CategoryBytes : Bytes)
+	{
+		Total += CategoryBytes;
+	}
+	return Total;
+}
+
+void FGGActorMemoryFootprint::Accumulate(const FGGActorMemoryFootprint& Other)
+{
+	for (int32 Category = 0; Category < UE_ARRAY_COUNT(Bytes); ++Category)
+	{
+		Bytes[Category] += Other.Bytes[Category];
+	}
+	NumAbilitySpecs	  += Other.NumAbilitySpecs;
+	NumActiveEffects  += Other.NumActiveEffects;
+	NumEffectContexts += Other.NumEffectContexts;
+}
+
+const TCHAR* FGGActorMemoryFootprint::GetCategoryName(EGGMemoryCategory Category)
+{
+	switch (Category)
+	{
+	case EGGMemoryCategory::Actor:			return TEXT("Actor");
+	case EGGMemoryCategory::AbilitySystem:	return TEXT("AbilitySystem");
+	case EGGMemoryCategory::AttributeSets:	return TEXT("AttributeSets");
+	case EGGMemoryCategory::AbilitySpecs:	return TEXT("AbilitySpecs");
+	case EGGMemoryCategory::ActiveEffects:	return TEXT("ActiveEffects");
+	case EGGMemoryCategory::EffectContexts:	return TEXT("EffectContexts");
+	case EGGMemoryCategory::Cameras:		return TEXT("Cameras");
+	default:								return TEXT("Unknown");
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FGGMemoryReport
+
+/**
+ *  Measures every live AGGCharacterBase and AGGDestructible of the world.
+ * @param World The world to walk
+ * @return One footprint per actor
+ */
+FGGMemoryReport FGGMemoryReport::Gather(UWorld* World)
+{
+	FGGMemoryReport Report;
+	if (!World)
+	{
+		return Report;
+	}
+
+	TSet<const FGameplayEffectContext*> CountedContexts;
+	for (TActorIterator<AGGCharacterBase> It(World); It; ++It)
+	{
+		Report.Actors.Add(Measure(*It, CountedContexts));
+	}
+	for (TActorIterator<AGGDestructible> It(World); It; ++It)
+	{
+		Report.Actors.Add(Measure(*It, CountedContexts));
+	}
+	return Report;
+}
+
+/**
+ *  Measures the actor, its components and the ability system it exposes through
+ *  IAbilitySystemInterface.
+ * @param Actor The actor to measure
+ * @param CountedContexts Effect contexts already counted for another actor
+ * @return The footprint of the actor
+ */
+FGGActorMemoryFootprint FGGMemoryReport::Measure(const AActor* Actor,
+	TSet<const FGameplayEffectContext*>& CountedContexts)
+{
+	FGGActorMemoryFootprint Footprint;
+	if (!Actor)
+	{
+		return Footprint;
+	}
+
+	Footprint.ActorName = Actor->GetName();
+	Footprint.ClassName = Actor->GetClass()->GetFName();
+	Footprint[EGGMemoryCategory::Actor] += Actor->GetClass()->GetStructureSize();
+
+	const IAbilitySystemInterface* AbilitySystemInterface = Cast<IAbilitySystemInterface>(Actor);
+	const UAbilitySystemComponent* AbilitySystemComponent =
+		AbilitySystemInterface ? AbilitySystemInterface->GetAbilitySystemComponent() : nullptr;
+
+	for (const UActorComponent* Component : Actor->GetComponents())
+	{
+		if (!Component || Component == AbilitySystemComponent)
+		{
+			continue;
+		}
+
+		const bool bIsCamera = Component->IsA<UCameraComponent>() || Component->IsA<USpringArmComponent>();
+		Footprint[bIsCamera ? EGGMemoryCategory::Cameras : EGGMemoryCategory::Actor] +=
+			Component->GetClass()->GetStructureSize();
+	}
+
+	if (const UGGAbilitySystemComponent* GGAbilitySystemComponent = Cast<UGGAbilitySystemComponent>(AbilitySystemComponent))
+	{
+		GGAbilitySystemComponent->AccumulateMemoryFootprint(Footprint, CountedContexts);
+	}
+	else if (AbilitySystemComponent)
+	{
+		// Only the project component exposes its specs and effects, so report what is public
+		Footprint[EGGMemoryCategory::AbilitySystem] += AbilitySystemComponent->GetClass()->GetStructureSize();
+		for (const UAttributeSet* AttributeSet : AbilitySystemComponent->GetSpawnedAttributes())
+		{
+			if (AttributeSet)
+			{
+				Footprint[EGGMemoryCategory::AttributeSets] += AttributeSet->GetClass()->GetStructureSize();
+			}
+		}
+	}
+
+	return Footprint;
+}
+
+TArray<FGGActorMemoryFootprint> FGGMemoryReport::GetClassTotals(TArray<int32>& OutActorCounts) const
+{
+	TMap<FName, int32> ClassIndices;
+	TArray<FGGActorMemoryFootprint> ClassTotals;
+	OutActorCounts.Reset();
+
+	for (const FGGActorMemoryFootprint& Footprint : Actors)
+	{
+		int32& Index = ClassIndices.FindOrAdd(Footprint.ClassName, INDEX_NONE);
+		if (Index == INDEX_NONE)
+		{
+			Index = ClassTotals.AddDefaulted();
+			ClassTotals[Index].ClassName = Footprint.ClassName;
+			ClassTotals[Index].ActorName = Footprint.ClassName.ToString();
+			OutActorCounts.Add(0);
+		}
+		ClassTotals[Index].Accumulate(Footprint);
+		++OutActorCounts[Index];
+	}
+
+	// Sort both arrays together, largest class first
+	TArray<int32> Order;
+	Order.Reserve(ClassTotals.Num());
+	for (int32 Index = 0; Index < ClassTotals.Num(); ++Index)
+	{
+		Order.Add(Index);
+	}
+	Order.Sort([&ClassTotals](int32 A, int32 B) { return ClassTotals[A].GetTotal() > ClassTotals[B].GetTotal(); });
+
+	TArray<FGGActorMemoryFootprint> SortedTotals;
+	TArray<int32> SortedCounts;
+	SortedTotals.Reserve(Order.Num());
+	SortedCounts.Reserve(Order.Num());
+	for (const int32 Index : Order)
+	{
+		SortedTotals.Add(MoveTemp(ClassTotals[Index]));
+		SortedCounts.Add(OutActorCounts[Index]);
+	}
+	OutActorCounts = MoveTemp(SortedCounts);
+	return SortedTotals;
+}
+
+static FString FormatFootprint(const FGGActorMemoryFootprint& Footprint, int32 ActorCount)
+{
+	FString Line = FString::Printf(TEXT("%8.1f KB"), Footprint.GetTotal() / 1024.0);
+	if (ActorCount > 1)
+	{
+		Line += FString::Printf(TEXT(" (%6.1f KB each)"), Footprint.GetTotal() / 1024.0 / ActorCount);
+	}
+	for (int32 Category = 0; Category < static_cast<int32>(EGGMemoryCategory::Count); ++Category)
+	{
+		Line += FString::Printf(TEXT(" | %s %.1f"),
+			FGGActorMemoryFootprint::GetCategoryName(static_cast<EGGMemoryCategory>(Category)),
+			Footprint.Bytes[Category] / 1024.0);
+	}
+	Line += FString::Printf(TEXT(" | %d specs, %d effects, %d contexts"),
+		Footprint.NumAbilitySpecs, Footprint.NumActiveEffects, Footprint.NumEffectContexts);
+	return Line;
+}
+
+/**
+ *  Logs the total footprint, one line per class and, if asked, one line per actor.
+ *  Category sizes are in kilobytes.
+ * @param Ar Where to write the report
+ * @param bPerActor True to list every actor after the class totals
+ */
+void FGGMemoryReport::Log(FOutputDevice& Ar, bool bPerActor) const
+{
+	FGGActorMemoryFootprint Total;
+	for (const FGGActorMemoryFootprint& Footprint : Actors)
+	{
+		Total.Accumulate(Footprint);
+	}
+
+	Ar.Logf(TEXT("GAS memory report: %d actors"), Actors.Num());
+	Ar.Logf(TEXT("  %-40s %s"), TEXT("Total"), *FormatFootprint(Total, Actors.Num()));
+
+	TArray<int32> ActorCounts;
+	const TArray<FGGActorMemoryFootprint> ClassTotals = GetClassTotals(ActorCounts);
+	for (int32 Index = 0; Index < ClassTotals.Num(); ++Index)
+	{
+		Ar.Logf(TEXT("  %-40s %s"),
+			*FString::Printf(TEXT("%s x%d"), *ClassTotals[Index].ActorName, ActorCounts[Index]),
+			*FormatFootprint(ClassTotals[Index], ActorCounts[Index]));
+	}
+
+	if (bPerActor)
+	{
+		for (const FGGActorMemoryFootprint& Footprint : Actors)
+		{
+			Ar.Logf(TEXT("    %-38s %s"), *Footprint.ActorName, *FormatFootprint(Footprint, 1));
+		}
+	}
+}
+
+/**
+ *  Writes the report as CSV, with sizes in bytes, so snapshots can be compared between builds.
+ * @param FilePath Where to write the file
+ * @return True if the file was written
+ */
+bool FGGMemoryReport::WriteCSV(const FString& FilePath) const
+{
+	FString CSV = TEXT("Scope,Class,Name,Actors");
+	for (int32 Category = 0; Category < static_cast<int32>(EGGMemoryCategory::Count); ++Category)
+	{
+		CSV += TEXT(",");
+		CSV += FGGActorMemoryFootprint::GetCategoryName(static_cast<EGGMemoryCategory>(Category));
+	}
+	CSV += TEXT(",Total,AbilitySpecs,ActiveEffects,EffectContexts\n");
+
+	auto AddRow = [&CSV](const TCHAR* Scope, const FGGActorMemoryFootprint& Footprint, int32 ActorCount)
+	{
+		CSV += FString::Printf(TEXT("%s,%s,%s,%d"), Scope, *Footprint.ClassName.ToString(), *Footprint.ActorName, ActorCount);
+		for (const uint64 CategoryBytes : Footprint.Bytes)
+		{
+			CSV += FString::Printf(TEXT(",%llu"), CategoryBytes);
+		}
+		CSV += FString::Printf(TEXT(",%llu,%d,%d,%d\n"), Footprint.GetTotal(),
+			Footprint.NumAbilitySpecs, Footprint.NumActiveEffects, Footprint.NumEffectContexts);
+	};
+
+	FGGActorMemoryFootprint Total;
+	Total.ActorName = TEXT("Total");
+	for (const FGGActorMemoryFootprint& Footprint : Actors)
+	{
+		Total.Accumulate(Footprint);
+	}
+	AddRow(TEXT("Total"), Total, Actors.Num());
+
+	TArray<int32> ActorCounts;
+	const TArray<FGGActorMemoryFootprint> ClassTotals = GetClassTotals(ActorCounts);
+	for (int32 Index = 0; Index < ClassTotals.Num(); ++Index)
+	{
+		AddRow(TEXT("Class"), ClassTotals[Index], ActorCounts[Index]);
+	}
+
+	for (const FGGActorMemoryFootprint& Footprint : Actors)
+	{
+		AddRow(TEXT("Actor"), Footprint, 1);
+	}
+
+	if (!FFileHelper::SaveStringToFile(CSV, *FilePath))
+	{
+		UE_LOG(LogMemoryReport, Error, TEXT("Unable to write memory report '%s'"), *FilePath);
+		return false;
+	}
+	return true;
+}
+
+FString FGGMemoryReport::GetDefaultCSVPath(const UWorld* World)
+{
+	const FString MapName = World ? World->GetMapName() : FString(TEXT("NoWorld"));
+	return FPaths::Combine(FPaths::ProfilingDir(), TEXT("MemoryReports"),
+		FString::Printf(TEXT("%s-%s.csv"), *MapName, *FDateTime::Now().ToString()));
+}
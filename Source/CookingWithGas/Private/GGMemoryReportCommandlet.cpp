@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGMemoryReportCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GGCharacterBase.h"
+#include "GGDeferredWorkSubsystem.h"
+#include "GGMemoryReport.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+UGGMemoryReportCommandlet::UGGMemoryReportCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+/**
+ *  Reports the memory footprint of every map given on the command line.
+ * @param Params The commandlet command line
+ * @return 0 if every map was reported, 1 otherwise
+ */
+int32 UGGMemoryReportCommandlet::Main(const FString& Params)
+{
+	FString MapList;
+	if (!FParse::Value(*Params, TEXT("Map="), MapList))
+	{
+		UE_LOG(LogMemoryReport, Error, TEXT("Usage: -run=GGMemoryReport -Map=<map>[+<map>...] [-CSVDir=<directory>] [-Actors]"));
+		return 1;
+	}
+
+	FString CSVDir;
+	FParse::Value(*Params, TEXT("CSVDir="), CSVDir);
+	const bool bPerActor = FParse::Param(*Params, TEXT("Actors"));
+
+	TArray<FString> MapNames;
+	MapList.ParseIntoArray(MapNames, TEXT("+"));
+
+	int32 Result = 0;
+	for (const FString& MapName : MapNames)
+	{
+		UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+		UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+		if (!World)
+		{
+			UE_LOG(LogMemoryReport, Error, TEXT("Unable to load map '%s'"), *MapName);
+			Result = 1;
+			continue;
+		}
+
+		// Bring the world up like a standalone game, so characters and destructibles
+		// grant their default abilities and effects before they are measured
+		World->WorldType = EWorldType::Game;
+		World->AddToRoot();
+		UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.OwningGameInstance = GameInstance;
+		WorldContext.SetCurrentWorld(World);
+		World->SetGameInstance(GameInstance);
+
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false));
+		World->SetGameMode(FURL());
+		World->UpdateWorldComponents(true, false);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		// No player logs in, so characters without a controller are given their default one;
+		// abilities and effects are granted on possession, the effects through deferred work
+		for (TActorIterator<AGGCharacterBase> It(World); It; ++It)
+		{
+			if (!It->GetController())
+			{
+				It->SpawnDefaultController();
+			}
+			if (!It->GetController())
+			{
+				UE_LOG(LogMemoryReport, Warning, TEXT("%s has no default controller and is measured without its abilities"),
+					*It->GetName());
+			}
+		}
+		if (UGGDeferredWorkSubsystem* DeferredWork = World->GetSubsystem<UGGDeferredWorkSubsystem>())
+		{
+			DeferredWork->Flush();
+		}
+
+		const FGGMemoryReport Report = FGGMemoryReport::Gather(World);
+		UE_LOG(LogMemoryReport, Display, TEXT("%s"), *MapName);
+		Report.Log(*GLog, bPerActor);
+
+		const FString CSVPath = CSVDir.IsEmpty()
+			? FGGMemoryReport::GetDefaultCSVPath(World)
+			: FPaths::Combine(CSVDir, FPaths::GetBaseFilename(MapName) + TEXT(".csv"));
+		if (!Report.WriteCSV(CSVPath))
+		{
+			Result = 1;
+		}
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+		CollectGarbage(RF_NoFlags);
+	}
+
+	return Result;
+}
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGMovementLODSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GGEnemyCharacter.h"
+#include "HAL/IConsoleManager.h"
+
+static bool bMovementLODEnabled = true;
+static FAutoConsoleVariableRef CVarMovementLODEnabled(
+	TEXT("gg.MovementLOD.Enabled"), bMovementLODEnabled,
+	TEXT("If false, every enemy is switched back to full movement on the next update."));
+
+static float MovementLODInterval = 0.5f;
+static FAutoConsoleVariableRef CVarMovementLODInterval(
+	TEXT("gg.MovementLOD.Interval"), MovementLODInterval,
+	TEXT("Seconds between two checks of the enemies against the players."));
+
+static float MovementLODDistance = 4000.f;
+static FAutoConsoleVariableRef CVarMovementLODDistance(
+	TEXT("gg.MovementLOD.Distance"), MovementLODDistance,
+	TEXT("Distance from every player beyond which enemies use low detail movement, in world units."));
+
+static float MovementLODHysteresis = 0.8f;
+static FAutoConsoleVariableRef CVarMovementLODHysteresis(
+	TEXT("gg.MovementLOD.Hysteresis"), MovementLODHysteresis,
+	TEXT("Fraction of gg.MovementLOD.Distance a player has to come within to switch an enemy back to full movement."));
+
+bool UGGMovementLODSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGGMovementLODSubsystem::RegisterEnemy(AGGEnemyCharacter* Enemy)
+{
+	if (Enemy && Enemy->HasAuthority())
+	{
+		Enemies.AddUnique(Enemy);
+	}
+}
+
+int32 UGGMovementLODSubsystem::GetLowDetailCount() const
+{
+	int32 Count = 0;
+	for (const TWeakObjectPtr<AGGEnemyCharacter>& Enemy : Enemies)
+	{
+		Count += Enemy.IsValid() && Enemy->IsMovementLOD() ? 1 : 0;
+	}
+	return Count;
+}
+
+bool UGGMovementLODSubsystem::IsTickable() const
+{
+	return Enemies.Num() > 0;
+}
+
+TStatId UGGMovementLODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGMovementLODSubsystem, STATGROUP_Tickables);
+}
+
+void UGGMovementLODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now >= NextUpdateTime)
+	{
+		NextUpdateTime = Now + MovementLODInterval;
+		UpdateEnemies();
+	}
+}
+
+/**
+ *  Finds the closest player of each enemy and switches the enemy's movement detail, with
+ *  hysteresis so enemies at the edge do not flip every update.
+ */
+void UGGMovementLODSubsystem::UpdateEnemies()
+{
+	TArray<FVector, TInlineAllocator<8>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float FarDistanceSquared	= FMath::Square(MovementLODDistance);
+	const float NearDistanceSquared = FMath::Square(MovementLODDistance * MovementLODHysteresis);
+
+	for (int32 Index = Enemies.Num() - 1; Index >= 0; --Index)
+	{
+		AGGEnemyCharacter* Enemy = Enemies[Index].Get();
+		if (!Enemy)
+		{
+			Enemies.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (!bMovementLODEnabled || !Enemy->bAllowMovementLOD || Enemy->IsInCombat(Now))
+		{
+			Enemy->SetMovementLOD(false);
+			continue;
+		}
+
+		float ClosestDistanceSquared = TNumericLimits<float>::Max();
+		const FVector EnemyLocation = Enemy->GetActorLocation();
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared,
+				static_cast<float>(FVector::DistSquared(EnemyLocation, PlayerLocation)));
+		}
+
+		if (Enemy->IsMovementLOD() ? ClosestDistanceSquared < NearDistanceSquared : ClosestDistanceSquared > FarDistanceSquared)
+		{
+			Enemy->SetMovementLOD(!Enemy->IsMovementLOD());
+		}
+	}
+}
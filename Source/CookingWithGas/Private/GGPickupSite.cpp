@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGPickupSite.h"
+#include "Components/StaticMeshComponent.h"
+
+AGGPickupSite::AGGPickupSite()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = false;
+
+	Mesh = CreateDefaultSubobject<UStaticMeshComponent>("Mesh");
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetGenerateOverlapEvents(false);
+	SetRootComponent(Mesh);
+}
+
+void AGGPickupSite::SetAvailable(bool bNewAvailable)
+{
+	if (bAvailable == bNewAvailable)
+	{
+		return;
+	}
+
+	bAvailable = bNewAvailable;
+	SetActorHiddenInGame(!bAvailable);
+	OnAvailabilityChanged(bAvailable);
+}
@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGPickupSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameplayEffect.h"
+#include "GGDeferredWorkSubsystem.h"
+#include "GGPickupSite.h"
+#include "GGSpatialGrid.h"
+#include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
+
+DEFINE_LOG_CATEGORY(LogPickup);
+
+static float PickupCheckInterval = 0.1f;
+static FAutoConsoleVariableRef CVarPickupCheckInterval(
+	TEXT("gg.Pickup.CheckInterval"), PickupCheckInterval,
+	TEXT("Seconds between two checks of the players against nearby pickup sites."));
+
+static float PickupCellSize = 1000.f;
+static FAutoConsoleVariableRef CVarPickupCellSize(
+	TEXT("gg.Pickup.CellSize"), PickupCellSize,
+	TEXT("Size of the grid cells pickup sites are filed under, in world units. Read when the world begins play."));
+
+//////////////////////////////////////////////////////////////////////////
+// AGGPickupAvailability
+
+AGGPickupAvailability::AGGPickupAvailability()
+{
+	// Changes are pushed with ForceNetUpdate
+	NetUpdateFrequency = 1.f;
+}
+
+void AGGPickupAvailability::OnRep_AvailableBits()
+{
+	if (UGGPickupSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGPickupSubsystem>())
+	{
+		Subsystem->ApplyAvailableBits(AvailableBits);
+	}
+}
+
+void AGGPickupAvailability::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AGGPickupAvailability, AvailableBits);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UGGPickupSubsystem
+
+UGGPickupSubsystem::UGGPickupSubsystem()
+{
+	ReplicatorClass = AGGPickupAvailability::StaticClass();
+}
+
+void UGGPickupSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	// The replicator is sized by the sites, so they are indexed before it is spawned
+	EnsureSitesIndexed();
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (AGGPickupAvailability* Availability = GetReplicator<AGGPickupAvailability>())
+	{
+		// Every site starts available
+		Availability->AvailableBits.Init(~0u, FMath::DivideAndRoundUp(Sites.Num(), 32));
+	}
+}
+
+bool UGGPickupSubsystem::ShouldSpawnReplicator(const UWorld& InWorld) const
+{
+	return InWorld.GetNetMode() != NM_Client && Sites.Num() > 0;
+}
+
+void UGGPickupSubsystem::EnsureSitesIndexed()
+{
+	if (bSitesIndexed)
+	{
+		return;
+	}
+	bSitesIndexed = true;
+	CellSize = FMath::Max(PickupCellSize, 100.f);
+
+	TArray<TPair<FString, AGGPickupSite*>> SortedSites;
+	for (TActorIterator<AGGPickupSite> It(GetWorld()); It; ++It)
+	{
+		SortedSites.Emplace(UWorld::RemovePIEPrefix(It->GetPathName()), *It);
+	}
+	SortedSites.Sort([](const TPair<FString, AGGPickupSite*>& A, const TPair<FString, AGGPickupSite*>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	Sites.Reserve(SortedSites.Num());
+	SiteLocations.Reserve(SortedSites.Num());
+	for (const TPair<FString, AGGPickupSite*>& Pair : SortedSites)
+	{
+		const AGGPickupSite* Site = Pair.Value;
+		const int32 SiteIndex = Sites.Add(Pair.Value);
+		const FVector Location = Site->GetActorLocation();
+		SiteLocations.Add(Location);
+
+		GGSpatialGrid::ForEachCellInRadius(Location, Site->PickupRadius, CellSize, [this, SiteIndex](uint64 CellKey)
+		{
+			SitesByCell.FindOrAdd(CellKey).Add(SiteIndex);
+		});
+	}
+}
+
+bool UGGPickupSubsystem::IsTickable() const
+{
+	return GetReplicator<AGGPickupAvailability>() != nullptr;
+}
+
+TStatId UGGPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGPickupSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Brings back the sites whose respawn time has come, then checks the players when due.
+ * @param DeltaTime Unused; respawns and checks are scheduled on world time
+ */
+void UGGPickupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const auto EarliestFirst = [](const TPair<double, int32>& A, const TPair<double, int32>& B)
+	{
+		return A.Key < B.Key;
+	};
+	while (RespawnQueue.Num() > 0 && RespawnQueue.HeapTop().Key <= Now)
+	{
+		TPair<double, int32> Respawn;
+		RespawnQueue.HeapPop(Respawn, EarliestFirst, false);
+
+		// Nobody is waiting on the exact frame a pickup comes back
+		UGGDeferredWorkSubsystem::Submit(this, EGGDeferredWorkPriority::Low, this, [this, SiteIndex = Respawn.Value]()
+		{
+			SetSiteAvailable(SiteIndex, true);
+		});
+	}
+
+	if (Now >= NextCheckTime)
+	{
+		NextCheckTime = Now + PickupCheckInterval;
+		CheckPlayers();
+	}
+}
+
+/**
+ *  Looks up the grid cell of each player pawn and picks up every available site of that
+ *  cell within reach. The cost does not depend on how many sites the map has.
+ */
+void UGGPickupSubsystem::CheckPlayers()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (!Pawn)
+		{
+			continue;
+		}
+
+		const FVector PawnLocation = Pawn->GetActorLocation();
+		const TArray<int32, TInlineAllocator<4>>* CellSites = SitesByCell.Find(GGSpatialGrid::GetCellKey(PawnLocation, CellSize));
+		if (!CellSites)
+		{
+			continue;
+		}
+
+		for (const int32 SiteIndex : *CellSites)
+		{
+			const AGGPickupSite* Site = Sites[SiteIndex].Get();
+			if (Site && Site->IsAvailable()
+				&& FVector::DistSquared(PawnLocation, SiteLocations[SiteIndex]) <= FMath::Square(Site->PickupRadius))
+			{
+				TakePickup(SiteIndex, Pawn);
+			}
+		}
+	}
+}
+
+void UGGPickupSubsystem::TakePickup(int32 SiteIndex, APawn* Pawn)
+{
+	AGGPickupSite* Site = Sites[SiteIndex].Get();
+	UAbilitySystemComponent* AbilitySystemComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Pawn);
+	if (!Site || !AbilitySystemComponent)
+	{
+		return;
+	}
+
+	if (Site->PickupEffect)
+	{
+		FGameplayEffectContextHandle EffectContext = AbilitySystemComponent->MakeEffectContext();
+		EffectContext.AddSourceObject(Site);
+
+		const FGameplayEffectSpecHandle SpecHandle =
+			AbilitySystemComponent->MakeOutgoingSpec(Site->PickupEffect, Site->EffectLevel, EffectContext);
+		if (SpecHandle.IsValid())
+		{
+			AbilitySystemComponent->ApplyGameplayEffectSpecToSelf(*SpecHandle.Data.Get());
+		}
+	}
+
+	SetSiteAvailable(SiteIndex, false);
+	Site->OnPickedUp(Pawn);
+
+	if (Site->RespawnTime > 0.f)
+	{
+		RespawnQueue.HeapPush(TPair<double, int32>(GetWorld()->GetTimeSeconds() + Site->RespawnTime, SiteIndex),
+			[](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key < B.Key; });
+	}
+}
+
+void UGGPickupSubsystem::SetSiteAvailable(int32 SiteIndex, bool bAvailable)
+{
+	if (AGGPickupSite* Site = Sites[SiteIndex].Get())
+	{
+		Site->SetAvailable(bAvailable);
+	}
+
+	if (AGGPickupAvailability* Availability = GetReplicator<AGGPickupAvailability>())
+	{
+		uint32& Word = Availability->AvailableBits[SiteIndex / 32];
+		const uint32 Bit = 1u << (SiteIndex % 32);
+		Word = bAvailable ? (Word | Bit) : (Word & ~Bit);
+		Availability->ForceNetUpdate();
+	}
+}
+
+/**
+ *  Applies the server's bits, visiting only the words that changed since the last update.
+ * @param AvailableBits One bit per site, set while the site is available
+ */
+void UGGPickupSubsystem::ApplyAvailableBits(const TArray<uint32>& AvailableBits)
+{
+	EnsureSitesIndexed();
+	if (AvailableBits.Num() != FMath::DivideAndRoundUp(Sites.Num(), 32))
+	{
+		UE_LOG(LogPickup, Warning, TEXT("Pickup availability covers %d sites but %d are placed; are sites spawned at runtime?"),
+			AvailableBits.Num() * 32, Sites.Num());
+	}
+
+	// Sites start available, so words seen for the first time are compared against all set bits
+	const int32 PreviousNum = LastAppliedBits.Num();
+	LastAppliedBits.SetNum(AvailableBits.Num(), false);
+	for (int32 WordIndex = PreviousNum; WordIndex < LastAppliedBits.Num(); ++WordIndex)
+	{
+		LastAppliedBits[WordIndex] = ~0u;
+	}
+
+	for (int32 WordIndex = 0; WordIndex < AvailableBits.Num(); ++WordIndex)
+	{
+		const uint32 Changed = AvailableBits[WordIndex] ^ LastAppliedBits[WordIndex];
+		for (uint32 Bits = Changed; Bits != 0; Bits &= Bits - 1)
+		{
+			const int32 SiteIndex = WordIndex * 32 + FMath::CountTrailingZeros(Bits);
+			AGGPickupSite* Site = Sites.IsValidIndex(SiteIndex) ? Sites[SiteIndex].Get() : nullptr;
+			if (Site)
+			{
+				Site->SetAvailable((AvailableBits[WordIndex] & (1u << (SiteIndex % 32))) != 0);
+			}
+		}
+		LastAppliedBits[WordIndex] = AvailableBits[WordIndex];
+	}
+}
@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGPreloadSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GGCharacterBase.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY(LogPreload);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdPreloadReport(
+	TEXT("gg.Preload.Report"),
+	TEXT("Lists the preloaded pawn classes with their load times, and every synchronous load that was needed."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda(
+		[](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const UGGPreloadSubsystem* Subsystem = UGGPreloadSubsystem::Get(World))
+		{
+			Subsystem->LogReport(Ar);
+		}
+	}));
+
+UGGPreloadSubsystem* UGGPreloadSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine
+		? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull)
+		: nullptr;
+	return World ? UGameInstance::GetSubsystem<UGGPreloadSubsystem>(World->GetGameInstance()) : nullptr;
+}
+
+void UGGPreloadSubsystem::PreloadPawnClasses(const UObject* WorldContextObject,
+	const TArray<TSoftClassPtr<APawn>>& PawnClasses)
+{
+	if (UGGPreloadSubsystem* Subsystem = Get(WorldContextObject))
+	{
+		for (const TSoftClassPtr<APawn>& PawnClass : PawnClasses)
+		{
+			if (!PawnClass.IsNull())
+			{
+				Subsystem->RequestPreload(PawnClass.ToSoftObjectPath());
+			}
+		}
+	}
+}
+
+bool UGGPreloadSubsystem::IsPawnClassReady(const UObject* WorldContextObject, const TSoftClassPtr<APawn>& PawnClass)
+{
+	const UGGPreloadSubsystem* Subsystem = Get(WorldContextObject);
+	const FPreloadGroup* Group = Subsystem ? Subsystem->Groups.Find(PawnClass.ToSoftObjectPath()) : nullptr;
+	return Group && Group->bReady;
+}
+
+void UGGPreloadSubsystem::SpawnPawnWhenReady(const UObject* WorldContextObject, TSoftClassPtr<APawn> PawnClass,
+	const FTransform& SpawnTransform, FGGOnPreloadedPawnSpawned OnSpawned)
+{
+	UWorld* World = GEngine
+		? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull)
+		: nullptr;
+	UGGPreloadSubsystem* Subsystem = Get(World);
+	if (!Subsystem || PawnClass.IsNull())
+	{
+		OnSpawned.ExecuteIfBound(nullptr);
+		return;
+	}
+
+	const FSoftObjectPath ClassPath = PawnClass.ToSoftObjectPath();
+	FPendingSpawn PendingSpawn{ World, SpawnTransform, OnSpawned };
+
+	FPreloadGroup& Group = Subsystem->RequestPreload(ClassPath);
+	if (Group.bReady)
+	{
+		Subsystem->SpawnPending(ClassPath, PendingSpawn);
+	}
+	else
+	{
+		Group.PendingSpawns.Add(MoveTemp(PendingSpawn));
+	}
+}
+
+/**
+ *  Fallback for code that needs a class that was not preloaded. The load blocks the game
+ *  thread, so it is logged and added to the report.
+ * @param WorldContextObject Used to find the subsystem that keeps the report
+ * @param ClassPath The class to load
+ * @return The class, or nullptr if it could not be loaded
+ */
+UClass* UGGPreloadSubsystem::GetOrLoadClass(const UObject* WorldContextObject, const FSoftObjectPath& ClassPath)
+{
+	if (ClassPath.IsNull())
+	{
+		return nullptr;
+	}
+	if (UClass* Class = Cast<UClass>(ClassPath.ResolveObject()))
+	{
+		return Class;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	UClass* Class = Cast<UClass>(ClassPath.TryLoad());
+	const double LoadSeconds = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogPreload, Warning, TEXT("Synchronous load of %s took %.2f ms; add its owner to a preload"),
+		*ClassPath.ToString(), LoadSeconds * 1000.0);
+
+	if (UGGPreloadSubsystem* Subsystem = Get(WorldContextObject))
+	{
+		++Subsystem->NumSyncLoads;
+		Subsystem->SyncLoadSeconds += LoadSeconds;
+		Subsystem->SyncLoadedPaths.AddUnique(ClassPath);
+	}
+	return Class;
+}
+
+UGGPreloadSubsystem::FPreloadGroup& UGGPreloadSubsystem::RequestPreload(const FSoftObjectPath& ClassPath)
+{
+	if (FPreloadGroup* Existing = Groups.Find(ClassPath))
+	{
+		return *Existing;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (NumPendingGroups++ == 0)
+	{
+		FirstPendingRequestTime = Now;
+	}
+
+	FPreloadGroup& Group = Groups.Add(ClassPath);
+	Group.RequestTime = Now;
+
+	// The delegate may run before this returns if the class is already in memory
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPath,
+		FStreamableDelegate::CreateUObject(this, &UGGPreloadSubsystem::OnClassLoaded, ClassPath),
+		FStreamableManager::AsyncLoadHighPriority);
+
+	FPreloadGroup& AddedGroup = Groups.FindChecked(ClassPath);
+	AddedGroup.ClassHandle = MoveTemp(Handle);
+	return AddedGroup;
+}
+
+/**
+ *  Gathers what the loaded pawn class grants on spawn and loads it as the second half of the group.
+ * @param ClassPath The pawn class of the group
+ */
+void UGGPreloadSubsystem::OnClassLoaded(FSoftObjectPath ClassPath)
+{
+	FPreloadGroup* Group = Groups.Find(ClassPath);
+	if (!Group)
+	{
+		return;
+	}
+	Group->ClassLoadedTime = FPlatformTime::Seconds();
+
+	TArray<FSoftObjectPath> Dependencies;
+	const UClass* PawnClass = Cast<UClass>(ClassPath.ResolveObject());
+	if (const AGGCharacterBase* Character = PawnClass ? Cast<AGGCharacterBase>(PawnClass->GetDefaultObject()) : nullptr)
+	{
+		for (const TSoftClassPtr<UGGGameplayAbility>& Ability : Character->DefaultAbilities)
+		{
+			if (!Ability.IsNull() && !Ability.IsValid())
+			{
+				Dependencies.AddUnique(Ability.ToSoftObjectPath());
+			}
+		}
+		for (const TSoftClassPtr<UGameplayEffect>& Effect : Character->DefaultEffects)
+		{
+			if (!Effect.IsNull() && !Effect.IsValid())
+			{
+				Dependencies.AddUnique(Effect.ToSoftObjectPath());
+			}
+		}
+	}
+	else if (!PawnClass)
+	{
+		UE_LOG(LogPreload, Error, TEXT("Unable to preload pawn class %s"), *ClassPath.ToString());
+	}
+
+	Group->NumDependencies = Dependencies.Num();
+	if (Dependencies.Num() == 0)
+	{
+		OnDependenciesLoaded(ClassPath);
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(Dependencies),
+		FStreamableDelegate::CreateUObject(this, &UGGPreloadSubsystem::OnDependenciesLoaded, ClassPath),
+		FStreamableManager::AsyncLoadHighPriority);
+
+	if (FPreloadGroup* LoadingGroup = Groups.Find(ClassPath))
+	{
+		LoadingGroup->DependencyHandle = MoveTemp(Handle);
+	}
+}
+
+/**
+ *  Marks the group as ready and spawns every pawn that was waiting for it.
+ * @param ClassPath The pawn class of the group
+ */
+void UGGPreloadSubsystem::OnDependenciesLoaded(FSoftObjectPath ClassPath)
+{
+	FPreloadGroup* Group = Groups.Find(ClassPath);
+	if (!Group || Group->bReady)
+	{
+		return;
+	}
+
+	Group->bReady	 = true;
+	Group->ReadyTime = FPlatformTime::Seconds();
+	UE_LOG(LogPreload, Log, TEXT("Preloaded %s in %.2f ms (class %.2f ms, %d dependencies %.2f ms)"),
+		*ClassPath.GetAssetName(),
+		(Group->ReadyTime - Group->RequestTime) * 1000.0,
+		(Group->ClassLoadedTime - Group->RequestTime) * 1000.0,
+		Group->NumDependencies,
+		(Group->ReadyTime - Group->ClassLoadedTime) * 1000.0);
+
+	if (--NumPendingGroups == 0)
+	{
+		UE_LOG(LogPreload, Display, TEXT("All preloads finished %.2f ms after the first request"),
+			(Group->ReadyTime - FirstPendingRequestTime) * 1000.0);
+	}
+
+	TArray<FPendingSpawn> PendingSpawns = MoveTemp(Group->PendingSpawns);
+	for (FPendingSpawn& PendingSpawn : PendingSpawns)
+	{
+		SpawnPending(ClassPath, PendingSpawn);
+	}
+}
+
+void UGGPreloadSubsystem::SpawnPending(const FSoftObjectPath& ClassPath, FPendingSpawn& PendingSpawn)
+{
+	UWorld* World = PendingSpawn.World.Get();
+	UClass* PawnClass = Cast<UClass>(ClassPath.ResolveObject());
+	APawn* Pawn = nullptr;
+	if (World && PawnClass && PawnClass->IsChildOf<APawn>())
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		Pawn = World->SpawnActor<APawn>(PawnClass, PendingSpawn.SpawnTransform, SpawnParams);
+	}
+	PendingSpawn.OnSpawned.ExecuteIfBound(Pawn);
+}
+
+void UGGPreloadSubsystem::LogReport(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Preloaded pawn classes: %d (%d still loading)"), Groups.Num(), NumPendingGroups);
+	for (const TPair<FSoftObjectPath, FPreloadGroup>& Pair : Groups)
+	{
+		const FPreloadGroup& Group = Pair.Value;
+		if (Group.bReady)
+		{
+			Ar.Logf(TEXT("  %-48s %8.2f ms (class %.2f ms, %d dependencies %.2f ms)"),
+				*Pair.Key.GetAssetName(),
+				(Group.ReadyTime - Group.RequestTime) * 1000.0,
+				(Group.ClassLoadedTime - Group.RequestTime) * 1000.0,
+				Group.NumDependencies,
+				(Group.ReadyTime - Group.ClassLoadedTime) * 1000.0);
+		}
+		else
+		{
+			Ar.Logf(TEXT("  %-48s loading for %.2f ms"), *Pair.Key.GetAssetName(),
+				(FPlatformTime::Seconds() - Group.RequestTime) * 1000.0);
+		}
+	}
+
+	Ar.Logf(TEXT("Synchronous loads: %d, %.2f ms total"), NumSyncLoads, SyncLoadSeconds * 1000.0);
+	for (const FSoftObjectPath& Path : SyncLoadedPaths)
+	{
+		Ar.Logf(TEXT("  %s"), *Path.ToString());
+	}
+}
+
+void UGGPreloadSubsystem::Deinitialize()
+{
+	for (TPair<FSoftObjectPath, FPreloadGroup>& Pair : Groups)
+	{
+		if (Pair.Value.ClassHandle.IsValid())
+		{
+			Pair.Value.ClassHandle->CancelHandle();
+		}
+		if (Pair.Value.DependencyHandle.IsValid())
+		{
+			Pair.Value.DependencyHandle->CancelHandle();
+		}
+	}
+	Groups.Reset();
+	Super::Deinitialize();
+}
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGProjectileAbility.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameplayEffect.h"
+#include "GGAbilitySystemComponent.h"
+#include "GGProjectileAbilityData.h"
+#include "GGProjectileInterface.h"
+#include "GGShotEventSubsystem.h"
+
+UGGProjectileAbility::UGGProjectileAbility()
+{
+	// Never instanced; all per-type state lives in the projectile data asset
+	InstancingPolicy	= EGameplayAbilityInstancingPolicy::NonInstanced;
+	NetExecutionPolicy	= EGameplayAbilityNetExecutionPolicy::LocalPredicted;
+	AbilityInputID		= EAbilityInputID::Fire;
+}
+
+/**
+ *  Commits cost and cooldown from the projectile data, spawns the projectile on the
+ *  server and ends right away. Runs on the class default object.
+ */
+void UGGProjectileAbility::ActivateAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	const FGameplayEventData* TriggerEventData)
+{
+	const UGGProjectileAbilityData* ProjectileData = GetProjectileData(Handle, ActorInfo);
+	if (!ProjectileData || !CommitAbility(Handle, ActorInfo, ActivationInfo))
+	{
+		EndAbility(Handle, ActorInfo, ActivationInfo, true, true);
+		return;
+	}
+
+	if (ActorInfo->IsNetAuthority())
+	{
+		SpawnProjectile(Handle, ActorInfo, ActivationInfo, *ProjectileData);
+	}
+
+	EndAbility(Handle, ActorInfo, ActivationInfo, true, false);
+}
+
+bool UGGProjectileAbility::CheckCost(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, FGameplayTagContainer* OptionalRelevantTags) const
+{
+	if (!Super::CheckCost(Handle, ActorInfo, OptionalRelevantTags))
+	{
+		return false;
+	}
+
+	const UGGProjectileAbilityData* ProjectileData = GetProjectileData(Handle, ActorInfo);
+	if (!ProjectileData || !ProjectileData->CostEffect)
+	{
+		return true;
+	}
+
+	const UGameplayEffect* CostEffect = ProjectileData->CostEffect->GetDefaultObject<UGameplayEffect>();
+	if (!ActorInfo->AbilitySystemComponent->CanApplyAttributeModifiers(
+		CostEffect, GetAbilityLevel(Handle, ActorInfo), MakeEffectContext(Handle, ActorInfo)))
+	{
+		const FGameplayTag& CostTag = UAbilitySystemGlobals::Get().ActivateFailCostTag;
+		if (OptionalRelevantTags && CostTag.IsValid())
+		{
+			OptionalRelevantTags->AddTag(CostTag);
+		}
+		return false;
+	}
+	return true;
+}
+
+void UGGProjectileAbility::ApplyCost(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo) const
+{
+	Super::ApplyCost(Handle, ActorInfo, ActivationInfo);
+
+	const UGGProjectileAbilityData* ProjectileData = GetProjectileData(Handle, ActorInfo);
+	if (ProjectileData && ProjectileData->CostEffect)
+	{
+		ApplyGameplayEffectToOwner(Handle, ActorInfo, ActivationInfo,
+			ProjectileData->CostEffect->GetDefaultObject<UGameplayEffect>(), GetAbilityLevel(Handle, ActorInfo));
+	}
+}
+
+bool UGGProjectileAbility::CheckCooldown(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, FGameplayTagContainer* OptionalRelevantTags) const
+{
+	if (!Super::CheckCooldown(Handle, ActorInfo, OptionalRelevantTags))
+	{
+		return false;
+	}
+
+	const UGGProjectileAbilityData* ProjectileData = GetProjectileData(Handle, ActorInfo);
+	if (!ProjectileData || !ProjectileData->CooldownEffect)
+	{
+		return true;
+	}
+
+	const FGameplayTagContainer& CooldownTags =
+		ProjectileData->CooldownEffect->GetDefaultObject<UGameplayEffect>()->GetGrantedTags();
+	if (!CooldownTags.IsEmpty() && ActorInfo->AbilitySystemComponent->HasAnyMatchingGameplayTags(CooldownTags))
+	{
+		const FGameplayTag& CooldownTag = UAbilitySystemGlobals::Get().ActivateFailCooldownTag;
+		if (OptionalRelevantTags && CooldownTag.IsValid())
+		{
+			OptionalRelevantTags->AddTag(CooldownTag);
+		}
+		return false;
+	}
+	return true;
+}
+
+void UGGProjectileAbility::ApplyCooldown(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo) const
+{
+	Super::ApplyCooldown(Handle, ActorInfo, ActivationInfo);
+
+	const UGGProjectileAbilityData* ProjectileData = GetProjectileData(Handle, ActorInfo);
+	if (ProjectileData && ProjectileData->CooldownEffect)
+	{
+		ApplyGameplayEffectToOwner(Handle, ActorInfo, ActivationInfo,
+			ProjectileData->CooldownEffect->GetDefaultObject<UGameplayEffect>(), GetAbilityLevel(Handle, ActorInfo));
+	}
+}
+
+const UGGProjectileAbilityData* UGGProjectileAbility::GetProjectileData(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo) const
+{
+	if (ActorInfo && ActorInfo->AbilitySystemComponent.IsValid())
+	{
+		const UAbilitySystemComponent* AbilitySystem = ActorInfo->AbilitySystemComponent.Get();
+		const UGGAbilitySystemComponent* GGAbilitySystem = Cast<UGGAbilitySystemComponent>(AbilitySystem);
+		const FGameplayAbilitySpec* Spec = GGAbilitySystem
+			? GGAbilitySystem->FindAbilitySpecFromHandleFast(Handle)
+			: AbilitySystem->FindAbilitySpecFromHandle(Handle);
+		if (const UGGProjectileAbilityData* ProjectileData =
+			Spec ? Cast<UGGProjectileAbilityData>(Spec->SourceObject.Get()) : nullptr)
+		{
+			return ProjectileData;
+		}
+	}
+	return DefaultProjectileData;
+}
+
+/**
+ *  Spawns the projectile from the avatar's view point and gives it a damage spec
+ *  built from the projectile data, tagged with the damage type. Projectiles with a
+ *  cosmetic class reach clients as shot events instead of replicated actors.
+ */
+void UGGProjectileAbility::SpawnProjectile(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	const UGGProjectileAbilityData& ProjectileData) const
+{
+	AActor* Avatar = ActorInfo->AvatarActor.Get();
+	UWorld* World  = Avatar ? Avatar->GetWorld() : nullptr;
+	if (!World || !ProjectileData.ProjectileClass)
+	{
+		return;
+	}
+
+	FVector Origin;
+	FRotator ViewRotation;
+	Avatar->GetActorEyesViewPoint(Origin, ViewRotation);
+	Origin += ViewRotation.Vector() * ProjectileData.MuzzleOffset;
+
+	FGameplayEffectSpecHandle DamageSpec;
+	if (ProjectileData.DamageEffect)
+	{
+		DamageSpec = MakeOutgoingGameplayEffectSpec(Handle, ActorInfo, ActivationInfo,
+			ProjectileData.DamageEffect, GetAbilityLevel(Handle, ActorInfo));
+		if (DamageSpec.IsValid())
+		{
+			if (ProjectileData.DamageTypeTag.IsValid())
+			{
+				DamageSpec.Data->AddDynamicAssetTag(ProjectileData.DamageTypeTag);
+			}
+			if (ProjectileData.Damage > 0.f)
+			{
+				static const FGameplayTag SetByCallerTag =
+					FGameplayTag::RequestGameplayTag(FName("Damage.SetByCaller"), false);
+				DamageSpec.Data->SetSetByCallerMagnitude(SetByCallerTag, ProjectileData.Damage);
+			}
+		}
+	}
+
+	const FTransform SpawnTransform(ViewRotation, Origin);
+	AActor* Projectile = World->SpawnActorDeferred<AActor>(ProjectileData.ProjectileClass, SpawnTransform,
+		Avatar, Cast<APawn>(Avatar), ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Projectile)
+	{
+		return;
+	}
+
+	if (Projectile->Implements<UGGProjectileInterface>())
+	{
+		IGGProjectileInterface::Execute_InitializeProjectile(Projectile, DamageSpec);
+	}
+	Projectile->FinishSpawning(SpawnTransform);
+
+	UGGShotEventSubsystem::ReplicateAsShotEvent(Projectile, ProjectileData.CosmeticProjectileClass);
+}
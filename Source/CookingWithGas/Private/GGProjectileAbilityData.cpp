@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGProjectileAbilityData.h"
+#include "GGProjectileAbility.h"
+
+UGGProjectileAbilityData::UGGProjectileAbilityData()
+{
+	AbilityClass = UGGProjectileAbility::StaticClass();
+}
+
+FPrimaryAssetId UGGProjectileAbilityData::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(FPrimaryAssetType("ProjectileAbility"), GetFName());
+}
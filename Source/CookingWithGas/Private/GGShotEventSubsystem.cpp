@@ -0,0 +1,248 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGShotEventSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "GGProjectileInterface.h"
+#include "HAL/IConsoleManager.h"
+
+static bool bShotEventsEnabled = true;
+static FAutoConsoleVariableRef CVarShotEventsEnabled(
+	TEXT("gg.ShotEvents.Enabled"), bShotEventsEnabled,
+	TEXT("Sends projectiles that have a cosmetic class as shot events instead of replicated actors."));
+
+static int32 ShotEventsMaxEventsPerRPC = 64;
+static FAutoConsoleVariableRef CVarShotEventsMaxEventsPerRPC(
+	TEXT("gg.ShotEvents.MaxEventsPerRPC"), ShotEventsMaxEventsPerRPC,
+	TEXT("Most shots packed into one multicast; busier frames send several. Capped at 255."));
+
+static float ShotEventsMaxFastForwardMs = 300.f;
+static FAutoConsoleVariableRef CVarShotEventsMaxFastForwardMs(
+	TEXT("gg.ShotEvents.MaxFastForwardMs"), ShotEventsMaxFastForwardMs,
+	TEXT("Longest time, in milliseconds, clients move a cosmetic projectile forward to catch up with the server's."));
+
+// Bits of the flags byte written before each event
+namespace GGShotEventFlags
+{
+	enum : uint8
+	{
+		HasInstigator	= 1 << 0,
+		HasSpeed		= 1 << 1,
+	};
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FGGShotEventBatch
+
+bool FGGShotEventBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << ServerTime;
+
+	const auto GetFlags = [](const FGGShotEvent& Event) -> uint8
+	{
+		uint8 Flags = 0;
+		Flags |= Event.Instigator.IsValid()	? GGShotEventFlags::HasInstigator	: 0;
+		Flags |= Event.Speed > 0.f			? GGShotEventFlags::HasSpeed		: 0;
+		return Flags;
+	};
+
+	bOutSuccess = TGGEventBatcher<FGGShotEventBatch>::NetSerializeEvents(Ar, Events, GetFlags,
+		[&Ar, Map](FGGShotEvent& Event, uint8 Flags)
+	{
+		UObject* ProjectileClass = Event.ProjectileClass.Get();
+		Map->SerializeObject(Ar, UClass::StaticClass(), ProjectileClass);
+		Event.ProjectileClass = Cast<UClass>(ProjectileClass);
+
+		if (Flags & GGShotEventFlags::HasInstigator)
+		{
+			UObject* Instigator = Event.Instigator.Get();
+			Map->SerializeObject(Ar, AActor::StaticClass(), Instigator);
+			Event.Instigator = Cast<AActor>(Instigator);
+		}
+
+		bool bOriginSuccess = true;
+		bool bDirectionSuccess = true;
+		Event.Origin.NetSerialize(Ar, Map, bOriginSuccess);
+		Event.Direction.NetSerialize(Ar, Map, bDirectionSuccess);
+
+		if (Flags & GGShotEventFlags::HasSpeed)
+		{
+			FFloat16 Speed(Event.Speed);
+			Ar << Speed.Encoded;
+			Event.Speed = Speed;
+		}
+		else
+		{
+			Event.Speed = 0.f;
+		}
+
+		Ar << Event.Seed;
+
+		return bOriginSuccess && bDirectionSuccess;
+	});
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// AGGShotEventReplicator
+
+void AGGShotEventReplicator::MulticastShotEvents_Implementation(const FGGShotEventBatch& Batch)
+{
+	// Listen servers already show their own projectiles
+	if (GetNetMode() != NM_Client)
+	{
+		return;
+	}
+
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const float ServerTime = GameState ? static_cast<float>(GameState->GetServerWorldTimeSeconds()) : Batch.ServerTime;
+	const float FastForwardTime = FMath::Clamp(ServerTime - Batch.ServerTime, 0.f, ShotEventsMaxFastForwardMs * 0.001f);
+
+	for (const FGGShotEvent& Event : Batch.Events)
+	{
+		if (Event.ProjectileClass)
+		{
+			SpawnCosmeticProjectile(Event, FastForwardTime);
+		}
+	}
+}
+
+/**
+ *  Spawns the local projectile for a shot and moves it to where the server's projectile
+ *  should be by now, following its projectile movement's velocity and gravity.
+ * @param Event The shot
+ * @param FastForwardTime Seconds since the server fired the shot
+ */
+void AGGShotEventReplicator::SpawnCosmeticProjectile(const FGGShotEvent& Event, float FastForwardTime) const
+{
+	UWorld* World = GetWorld();
+	const FVector Origin = Event.Origin;
+	const FVector Direction = FVector(Event.Direction).GetSafeNormal();
+	const FTransform SpawnTransform(Direction.Rotation(), Origin);
+
+	AActor* Shooter = Event.Instigator.Get();
+	AActor* Projectile = World->SpawnActorDeferred<AActor>(Event.ProjectileClass, SpawnTransform,
+		Shooter, Cast<APawn>(Shooter), ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Projectile)
+	{
+		return;
+	}
+
+	if (Projectile->Implements<UGGProjectileInterface>())
+	{
+		IGGProjectileInterface::Execute_InitializeCosmeticProjectile(Projectile, Event.Seed);
+	}
+	Projectile->FinishSpawning(SpawnTransform);
+
+	UProjectileMovementComponent* Movement = IsValid(Projectile)
+		? Projectile->FindComponentByClass<UProjectileMovementComponent>()
+		: nullptr;
+	if (!Movement)
+	{
+		return;
+	}
+
+	if (Event.Speed > 0.f)
+	{
+		Movement->Velocity = Direction * Event.Speed;
+	}
+	if (FastForwardTime <= 0.f)
+	{
+		return;
+	}
+
+	const FVector Gravity(0.f, 0.f, Movement->GetGravityZ());
+	const FVector Delta = Movement->Velocity * FastForwardTime + 0.5f * Gravity * FMath::Square(FastForwardTime);
+
+	// A shot that would already have hit something is dropped; its impact comes with the server's hit feedback
+	const UPrimitiveComponent* Collision = Movement->UpdatedPrimitive;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ShotEventFastForward), false, Projectile);
+	QueryParams.AddIgnoredActor(Shooter);
+	FHitResult Hit;
+	if (World->LineTraceSingleByChannel(Hit, Origin, Origin + Delta,
+		Collision ? Collision->GetCollisionObjectType() : ECC_WorldDynamic, QueryParams))
+	{
+		Projectile->Destroy();
+		return;
+	}
+
+	Projectile->SetActorLocation(Origin + Delta);
+	Movement->Velocity += Gravity * FastForwardTime;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UGGShotEventSubsystem
+
+UGGShotEventSubsystem::UGGShotEventSubsystem()
+{
+	ReplicatorClass = AGGShotEventReplicator::StaticClass();
+}
+
+/**
+ *  Turns off replication of the projectile and queues its shot for this frame's batch. Actor
+ *  channels are only opened when the net driver ticks, after the world, so the projectile is
+ *  never sent to clients.
+ * @param Projectile The projectile spawned on the server; its projectile movement gives the speed
+ * @param CosmeticClass The projectile clients spawn for the shot
+ * @return False on clients, in standalone games, with gg.ShotEvents.Enabled off or without a cosmetic class
+ */
+bool UGGShotEventSubsystem::ReplicateAsShotEvent(AActor* Projectile, TSubclassOf<AActor> CosmeticClass)
+{
+	UWorld* World = Projectile ? Projectile->GetWorld() : nullptr;
+	UGGShotEventSubsystem* Subsystem = World ? World->GetSubsystem<UGGShotEventSubsystem>() : nullptr;
+	if (!bShotEventsEnabled || !CosmeticClass || !Subsystem || !Subsystem->GetReplicator<AGGShotEventReplicator>() || !Projectile->HasAuthority())
+	{
+		return false;
+	}
+
+	Projectile->SetReplicates(false);
+
+	const UProjectileMovementComponent* Movement = Projectile->FindComponentByClass<UProjectileMovementComponent>();
+	const FVector Velocity = Movement ? Movement->Velocity : FVector::ZeroVector;
+
+	FGGShotEvent& Event = Subsystem->PendingEvents.Add();
+	Event.ProjectileClass = CosmeticClass;
+	Event.Instigator	  = Projectile->GetInstigator() ? Projectile->GetInstigator() : Projectile->GetOwner();
+	Event.Origin		  = Projectile->GetActorLocation();
+	Event.Direction		  = Velocity.IsNearlyZero() ? Projectile->GetActorForwardVector() : Velocity.GetSafeNormal();
+	Event.Speed			  = Velocity.Size();
+	Event.Seed			  = static_cast<uint16>(FMath::Rand() & 0xFFFF);
+	return true;
+}
+
+bool UGGShotEventSubsystem::IsTickable() const
+{
+	return PendingEvents.HasPendingEvents();
+}
+
+TStatId UGGShotEventSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGShotEventSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Sends every shot fired this frame, stamped with the server time clients fast-forward from.
+ * @param DeltaTime Unused
+ */
+void UGGShotEventSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	AGGShotEventReplicator* Replicator = GetReplicator<AGGShotEventReplicator>();
+	if (!Replicator)
+	{
+		PendingEvents.Reset();
+		return;
+	}
+
+	FGGShotEventBatch Batch;
+	Batch.ServerTime = static_cast<float>(GetWorld()->GetTimeSeconds());
+	PendingEvents.SendBatches(Batch, ShotEventsMaxEventsPerRPC, [Replicator](const FGGShotEventBatch& InBatch)
+	{
+		Replicator->MulticastShotEvents(InBatch);
+	});
+}
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGThreatTable.h"
+#include "GameFramework/Actor.h"
+#include "GGCharacterBase.h"
+
+// Largest decay exponent accumulated before the stored threat is rebased; e^20 keeps well within float range
+static constexpr float MaxDecayExponent = 20.f;
+
+/**
+ *  Changes the half-life of threat. Stored threat is first brought to its current value,
+ *  since it was scaled with the previous decay rate.
+ * @param InHalfLife Seconds for threat to halve; 0 or less for threat that never decays
+ * @param InMinThreat Threat under which an instigator is forgotten
+ * @param Now Current world time
+ */
+void FGGThreatTable::SetDecay(float InHalfLife, float InMinThreat, double Now)
+{
+	const float Decay = GetDecay(Now);
+	for (FEntry& Entry : Entries)
+	{
+		Entry.ScaledThreat *= Decay;
+	}
+
+	BaseTime  = Now;
+	DecayRate = InHalfLife > 0.f ? FMath::Loge(2.f) / InHalfLife : 0.f;
+	MinThreat = FMath::Max(InMinThreat, 0.f);
+}
+
+/**
+ *  Adds threat to the instigator's entry. A new instigator takes a free slot or, in a full
+ *  table, the slot of the weakest entry if it now has more threat than it. Forgotten
+ *  instigators and ones that are gone are replaced first.
+ * @param Instigator Who caused the threat, such as the instigator of a hit
+ * @param Threat Threat to add, such as the damage dealt
+ * @param Now Current world time
+ */
+void FGGThreatTable::AddThreat(AActor* Instigator, float Threat, double Now)
+{
+	if (!Instigator || Threat <= 0.f)
+	{
+		return;
+	}
+
+	Rebase(Now);
+	const float Decay = GetDecay(Now);
+	const float ScaledThreat = Threat / Decay;
+	const float ScaledMinThreat = MinThreat / Decay;
+
+	int32 Index = INDEX_NONE;
+	int32 WeakestIndex = INDEX_NONE;
+	float WeakestThreat = 0.f;
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		const FEntry& Entry = Entries[i];
+		if (Entry.Instigator == Instigator)
+		{
+			Index = i;
+			break;
+		}
+
+		const float EntryThreat = Entry.Instigator.IsValid() && Entry.ScaledThreat >= ScaledMinThreat ? Entry.ScaledThreat : -1.f;
+		if (WeakestIndex == INDEX_NONE || EntryThreat < WeakestThreat)
+		{
+			WeakestIndex  = i;
+			WeakestThreat = EntryThreat;
+		}
+	}
+
+	if (Index != INDEX_NONE)
+	{
+		Entries[Index].ScaledThreat += ScaledThreat;
+	}
+	else if (Entries.Num() < Capacity)
+	{
+		Index = Entries.Add({ Instigator, ScaledThreat });
+	}
+	else if (WeakestThreat < ScaledThreat)
+	{
+		Index = WeakestIndex;
+		Entries[Index] = { Instigator, ScaledThreat };
+		if (Index == TopIndex)
+		{
+			UpdateTopIndex();
+			return;
+		}
+	}
+	else
+	{
+		return;
+	}
+
+	if (!Entries.IsValidIndex(TopIndex) || Entries[Index].ScaledThreat > Entries[TopIndex].ScaledThreat)
+	{
+		TopIndex = Index;
+	}
+}
+
+float FGGThreatTable::GetThreat(const AActor* Instigator, double Now) const
+{
+	for (const FEntry& Entry : Entries)
+	{
+		if (Entry.Instigator == Instigator)
+		{
+			return Entry.ScaledThreat * GetDecay(Now);
+		}
+	}
+	return 0.f;
+}
+
+AActor* FGGThreatTable::GetTopThreat(double Now) const
+{
+	// Only a top instigator that died or went away needs a scan
+	if (!Entries.IsValidIndex(TopIndex) || !IsValidTarget(Entries[TopIndex].Instigator.Get()))
+	{
+		UpdateTopIndex();
+	}
+
+	if (!Entries.IsValidIndex(TopIndex))
+	{
+		return nullptr;
+	}
+
+	const FEntry& Top = Entries[TopIndex];
+	return Top.ScaledThreat * GetDecay(Now) >= MinThreat ? Top.Instigator.Get() : nullptr;
+}
+
+void FGGThreatTable::Remove(const AActor* Instigator)
+{
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		if (Entries[i].Instigator == Instigator)
+		{
+			Entries.RemoveAtSwap(i, 1, false);
+			UpdateTopIndex();
+			return;
+		}
+	}
+}
+
+void FGGThreatTable::Reset()
+{
+	Entries.Reset();
+	TopIndex = INDEX_NONE;
+}
+
+float FGGThreatTable::GetDecay(double Now) const
+{
+	return DecayRate > 0.f ? FMath::Exp(-DecayRate * static_cast<float>(Now - BaseTime)) : 1.f;
+}
+
+void FGGThreatTable::Rebase(double Now)
+{
+	if (DecayRate * static_cast<float>(Now - BaseTime) < MaxDecayExponent)
+	{
+		return;
+	}
+
+	const float Decay = GetDecay(Now);
+	for (FEntry& Entry : Entries)
+	{
+		Entry.ScaledThreat *= Decay;
+	}
+	BaseTime = Now;
+}
+
+void FGGThreatTable::UpdateTopIndex() const
+{
+	TopIndex = INDEX_NONE;
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		if (IsValidTarget(Entries[i].Instigator.Get())
+			&& (TopIndex == INDEX_NONE || Entries[i].ScaledThreat > Entries[TopIndex].ScaledThreat))
+		{
+			TopIndex = i;
+		}
+	}
+}
+
+bool FGGThreatTable::IsValidTarget(const AActor* Instigator)
+{
+	const AGGCharacterBase* Character = Cast<AGGCharacterBase>(Instigator);
+	return Instigator && !(Character && Character->IsDead());
+}
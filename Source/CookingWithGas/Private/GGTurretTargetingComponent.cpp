@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGTurretTargetingComponent.h"
+#include "Engine/World.h"
+#include "GGCharacterBase.h"
+#include "GGTurretTargetingSubsystem.h"
+#include "Net/UnrealNetwork.h"
+
+UGGTurretTargetingComponent::UGGTurretTargetingComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+	TargetClass = AGGCharacterBase::StaticClass();
+}
+
+void UGGTurretTargetingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Targets are chosen by the server and replicated to clients
+	if (GetNetMode() != NM_Client)
+	{
+		if (UGGTurretTargetingSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGTurretTargetingSubsystem>())
+		{
+			Subsystem->RegisterTurret(this);
+		}
+	}
+}
+
+void UGGTurretTargetingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGGTurretTargetingSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGTurretTargetingSubsystem>())
+	{
+		Subsystem->UnregisterTurret(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGGTurretTargetingComponent::RefreshRegistration()
+{
+	UGGTurretTargetingSubsystem* Subsystem = GetWorld()->GetSubsystem<UGGTurretTargetingSubsystem>();
+	if (Subsystem && TurretIndex != INDEX_NONE)
+	{
+		Subsystem->UnregisterTurret(this);
+		Subsystem->RegisterTurret(this);
+	}
+}
+
+void UGGTurretTargetingComponent::SetCurrentTarget(AActor* NewTarget)
+{
+	if (CurrentTarget == NewTarget)
+	{
+		return;
+	}
+
+	AActor* OldTarget = CurrentTarget;
+	CurrentTarget = NewTarget;
+	OnTargetChanged.Broadcast(NewTarget, OldTarget);
+}
+
+void UGGTurretTargetingComponent::OnRep_CurrentTarget(AActor* OldTarget)
+{
+	OnTargetChanged.Broadcast(CurrentTarget, OldTarget);
+}
+
+void UGGTurretTargetingComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UGGTurretTargetingComponent, CurrentTarget);
+}
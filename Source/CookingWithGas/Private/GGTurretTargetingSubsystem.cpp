@@ -0,0 +1,328 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGTurretTargetingSubsystem.h"
+#include "CollisionQueryParams.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GGAttributeSet.h"
+#include "GGCharacterBase.h"
+#include "GGSpatialGrid.h"
+#include "GGTurretTargetingComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static float TurretTargetingCandidateInterval = 0.1f;
+static FAutoConsoleVariableRef CVarTurretTargetingCandidateInterval(
+	TEXT("gg.TurretTargeting.CandidateInterval"), TurretTargetingCandidateInterval,
+	TEXT("Seconds between two gatherings of turret target candidates, shared by every turret."));
+
+static float TurretTargetingCellSize = 2000.f;
+static FAutoConsoleVariableRef CVarTurretTargetingCellSize(
+	TEXT("gg.TurretTargeting.CellSize"), TurretTargetingCellSize,
+	TEXT("Size of the grid cells used to match candidates with turrets, in world units."));
+
+static float TurretTargetingBudgetMs = 0.25f;
+static FAutoConsoleVariableRef CVarTurretTargetingBudgetMs(
+	TEXT("gg.TurretTargeting.BudgetMs"), TurretTargetingBudgetMs,
+	TEXT("Time allowed for turret target evaluations each frame, in milliseconds."));
+
+static int32 TurretTargetingMaxEvaluationsPerFrame = 16;
+static FAutoConsoleVariableRef CVarTurretTargetingMaxEvaluationsPerFrame(
+	TEXT("gg.TurretTargeting.MaxEvaluationsPerFrame"), TurretTargetingMaxEvaluationsPerFrame,
+	TEXT("Most turrets that get their target evaluated each frame."));
+
+static int32 TurretTargetingMaxTracesPerEvaluation = 3;
+static FAutoConsoleVariableRef CVarTurretTargetingMaxTracesPerEvaluation(
+	TEXT("gg.TurretTargeting.MaxTracesPerEvaluation"), TurretTargetingMaxTracesPerEvaluation,
+	TEXT("Most line of sight traces one evaluation makes before giving up on the remaining candidates."));
+
+void UGGTurretTargetingSubsystem::RegisterTurret(UGGTurretTargetingComponent* Turret)
+{
+	if (!Turret || Turret->TurretIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	FTurret Entry;
+	Entry.Component	   = Turret;
+	Entry.Location	   = Turret->GetComponentLocation();
+	Entry.RangeSquared = FMath::Square(Turret->Range);
+
+	Turret->TurretIndex = Turrets.Add(MoveTemp(Entry));
+	if (GridCellSize <= 0.f)
+	{
+		GridCellSize = FMath::Max(TurretTargetingCellSize, 100.f);
+	}
+	AddTurretToGrid(Turret->TurretIndex);
+}
+
+void UGGTurretTargetingSubsystem::UnregisterTurret(UGGTurretTargetingComponent* Turret)
+{
+	if (!Turret || !Turrets.IsValidIndex(Turret->TurretIndex))
+	{
+		return;
+	}
+
+	const int32 TurretIndex = Turret->TurretIndex;
+	RemoveTurretFromGrid(TurretIndex);
+	AwakeTurrets.RemoveSingleSwap(TurretIndex);
+	Turrets.RemoveAt(TurretIndex);
+	Turret->TurretIndex = INDEX_NONE;
+}
+
+void UGGTurretTargetingSubsystem::AddTurretToGrid(int32 TurretIndex)
+{
+	FTurret& Turret = Turrets[TurretIndex];
+	Turret.Cells.Reset();
+	GGSpatialGrid::ForEachCellInRadius(Turret.Location, FMath::Sqrt(Turret.RangeSquared), GridCellSize,
+		[this, &Turret, TurretIndex](uint64 CellKey)
+		{
+			Turret.Cells.Add(CellKey);
+			TurretsByCell.FindOrAdd(CellKey).Add(TurretIndex);
+		});
+}
+
+void UGGTurretTargetingSubsystem::RemoveTurretFromGrid(int32 TurretIndex)
+{
+	for (const uint64 CellKey : Turrets[TurretIndex].Cells)
+	{
+		if (TArray<int32, TInlineAllocator<4>>* CellTurrets = TurretsByCell.Find(CellKey))
+		{
+			CellTurrets->RemoveSingleSwap(TurretIndex);
+			if (CellTurrets->Num() == 0)
+			{
+				TurretsByCell.Remove(CellKey);
+			}
+		}
+	}
+	Turrets[TurretIndex].Cells.Reset();
+}
+
+bool UGGTurretTargetingSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UGGTurretTargetingSubsystem::IsTickable() const
+{
+	return Turrets.Num() > 0;
+}
+
+TStatId UGGTurretTargetingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGGTurretTargetingSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ *  Refreshes the candidates when due, then evaluates awake turrets round robin until the
+ *  frame budget is spent.
+ * @param DeltaTime Unused; evaluations are scheduled on world time
+ */
+void UGGTurretTargetingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now >= NextCandidateRefreshTime)
+	{
+		NextCandidateRefreshTime = Now + TurretTargetingCandidateInterval;
+		RefreshCandidates(Now);
+	}
+
+	if (AwakeTurrets.Num() == 0)
+	{
+		return;
+	}
+
+	const double BudgetEnd = FPlatformTime::Seconds() + TurretTargetingBudgetMs / 1000.0;
+	int32 Evaluations = 0;
+	for (int32 Visited = 0; Visited < AwakeTurrets.Num(); ++Visited)
+	{
+		// Target change listeners may have unregistered turrets
+		if (AwakeTurrets.Num() == 0
+			|| Evaluations >= TurretTargetingMaxEvaluationsPerFrame || FPlatformTime::Seconds() >= BudgetEnd)
+		{
+			break;
+		}
+
+		EvaluationCursor = EvaluationCursor % AwakeTurrets.Num();
+		FTurret& Turret = Turrets[AwakeTurrets[EvaluationCursor]];
+		++EvaluationCursor;
+
+		if (Now >= Turret.NextEvaluationTime)
+		{
+			EvaluateTurret(Turret, Now);
+			++Evaluations;
+		}
+	}
+}
+
+/**
+ *  One pass over the living characters. Each candidate is filed under its grid cell, and every
+ *  turret registered on an occupied cell is woken up. Turrets that have no candidate near them
+ *  anymore lose their target and go back to sleep.
+ * @param Now The current world time
+ */
+void UGGTurretTargetingSubsystem::RefreshCandidates(double Now)
+{
+	// The cell size changed through its console variable, so every turret gets its cells again
+	const float CellSize = FMath::Max(TurretTargetingCellSize, 100.f);
+	if (CellSize != GridCellSize)
+	{
+		GridCellSize = CellSize;
+		TurretsByCell.Reset();
+		for (TSparseArray<FTurret>::TIterator It(Turrets); It; ++It)
+		{
+			AddTurretToGrid(It.GetIndex());
+		}
+	}
+
+	Candidates.Reset();
+	for (TPair<uint64, TArray<int32, TInlineAllocator<4>>>& Pair : CandidatesByCell)
+	{
+		Pair.Value.Reset();
+	}
+
+	TBitArray<> Awake(false, Turrets.GetMaxIndex());
+	for (TActorIterator<AGGCharacterBase> It(GetWorld()); It; ++It)
+	{
+		AGGCharacterBase* Character = *It;
+		if (Character->AttributeSet && Character->AttributeSet->GetHealth() <= 0.f)
+		{
+			continue;
+		}
+
+		const uint64 CellKey = GGSpatialGrid::GetCellKey(Character->GetActorLocation(), GridCellSize);
+
+		// Only cells that a turret covers are worth filing the candidate under
+		const TArray<int32, TInlineAllocator<4>>* CellTurrets = TurretsByCell.Find(CellKey);
+		if (!CellTurrets)
+		{
+			continue;
+		}
+
+		const int32 CandidateIndex = Candidates.Add(Character);
+		CandidatesByCell.FindOrAdd(CellKey).Add(CandidateIndex);
+		for (const int32 TurretIndex : *CellTurrets)
+		{
+			Awake[TurretIndex] = true;
+		}
+	}
+
+	// Put turrets to sleep that no longer have anything near them
+	TArray<TWeakObjectPtr<UGGTurretTargetingComponent>, TInlineAllocator<8>> SleepingTurrets;
+	for (const int32 TurretIndex : AwakeTurrets)
+	{
+		if (!Awake[TurretIndex])
+		{
+			Turrets[TurretIndex].bAwake = false;
+			SleepingTurrets.Add(Turrets[TurretIndex].Component);
+		}
+	}
+
+	AwakeTurrets.Reset();
+	for (TConstSetBitIterator<> It(Awake); It; ++It)
+	{
+		FTurret& Turret = Turrets[It.GetIndex()];
+		if (!Turret.bAwake)
+		{
+			// Just woke up: evaluate it as soon as the budget allows
+			Turret.bAwake = true;
+			Turret.NextEvaluationTime = Now;
+		}
+		AwakeTurrets.Add(It.GetIndex());
+	}
+
+	// Cleared last, since target change listeners may register or unregister turrets
+	for (const TWeakObjectPtr<UGGTurretTargetingComponent>& Component : SleepingTurrets)
+	{
+		if (Component.IsValid())
+		{
+			Component->SetCurrentTarget(nullptr);
+		}
+	}
+}
+
+/**
+ *  Scores the candidates in the turret's cells by distance, giving the current target an edge,
+ *  then traces line of sight to the best ones in order until one is visible.
+ * @param Turret The turret to evaluate
+ * @param Now The current world time
+ */
+void UGGTurretTargetingSubsystem::EvaluateTurret(FTurret& Turret, double Now)
+{
+	UGGTurretTargetingComponent* Component = Turret.Component.Get();
+	if (!Component)
+	{
+		return;
+	}
+	Turret.NextEvaluationTime = Now + Component->ReevaluationInterval;
+
+	const AActor* Owner = Component->GetOwner();
+	const AActor* CurrentTarget = Component->GetCurrentTarget();
+	const float CurrentTargetScale = FMath::Square(1.f - Component->TargetStickiness);
+
+	TArray<TPair<float, AGGCharacterBase*>, TInlineAllocator<16>> Scored;
+	for (const uint64 CellKey : Turret.Cells)
+	{
+		const TArray<int32, TInlineAllocator<4>>* CellCandidates = CandidatesByCell.Find(CellKey);
+		if (!CellCandidates)
+		{
+			continue;
+		}
+
+		for (const int32 CandidateIndex : *CellCandidates)
+		{
+			AGGCharacterBase* Candidate = Candidates[CandidateIndex].Get();
+			if (!Candidate || Candidate == Owner
+				|| (Component->TargetClass && !Candidate->IsA(Component->TargetClass)))
+			{
+				continue;
+			}
+
+			float DistanceSquared = FVector::DistSquared(Turret.Location, Candidate->GetActorLocation());
+			if (DistanceSquared > Turret.RangeSquared)
+			{
+				continue;
+			}
+			if (Candidate == CurrentTarget)
+			{
+				DistanceSquared *= CurrentTargetScale;
+			}
+			Scored.Emplace(DistanceSquared, Candidate);
+		}
+	}
+
+	Scored.Sort([](const TPair<float, AGGCharacterBase*>& A, const TPair<float, AGGCharacterBase*>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	AActor* NewTarget = nullptr;
+	if (!Component->bRequireLineOfSight)
+	{
+		NewTarget = Scored.Num() > 0 ? Scored[0].Value : nullptr;
+	}
+	else
+	{
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TurretLineOfSight), false, Owner);
+		const int32 MaxTraces = FMath::Min(Scored.Num(), FMath::Max(TurretTargetingMaxTracesPerEvaluation, 1));
+		for (int32 i = 0; i < MaxTraces; ++i)
+		{
+			AGGCharacterBase* Candidate = Scored[i].Value;
+			QueryParams.ClearIgnoredActors();
+			QueryParams.AddIgnoredActor(Owner);
+			QueryParams.AddIgnoredActor(Candidate);
+			if (!GetWorld()->LineTraceTestByChannel(Turret.Location, Candidate->GetActorLocation(),
+				ECC_Visibility, QueryParams))
+			{
+				NewTarget = Candidate;
+				break;
+			}
+		}
+	}
+
+	Component->SetCurrentTarget(NewTarget);
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGWorldReplicator.h"
+#include "Engine/World.h"
+
+//////////////////////////////////////////////////////////////////////////
+// AGGWorldReplicator
+
+AGGWorldReplicator::AGGWorldReplicator()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates		= true;
+	bAlwaysRelevant	= true;
+	SetReplicatingMovement(false);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UGGWorldReplicatorSubsystem
+
+bool UGGWorldReplicatorSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGGWorldReplicatorSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (ReplicatorClass && ShouldSpawnReplicator(InWorld))
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		Replicator = InWorld.SpawnActor<AGGWorldReplicator>(ReplicatorClass, SpawnParams);
+	}
+}
+
+bool UGGWorldReplicatorSubsystem::ShouldSpawnReplicator(const UWorld& InWorld) const
+{
+	const ENetMode NetMode = InWorld.GetNetMode();
+	return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGDeferredWorkSubsystem.h"
+#include "GGTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGGDeferredWorkFlushTest, "CookingWithGas.DeferredWork.Flush",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+/**
+ *  Queues work of every priority and flushes it: everything runs, highest priority first, and
+ *  work submitted while flushing runs before the flush returns, ahead of lower priorities.
+ */
+bool FGGDeferredWorkFlushTest::RunTest(const FString& Parameters)
+{
+	FGGTestWorld TestWorld;
+	UWorld* World = TestWorld.World;
+
+	UGGDeferredWorkSubsystem* DeferredWork = World->GetSubsystem<UGGDeferredWorkSubsystem>();
+	if (TestNotNull(TEXT("Subsystem"), DeferredWork))
+	{
+		TArray<FString> Ran;
+		UGGDeferredWorkSubsystem::Submit(World, EGGDeferredWorkPriority::Low, nullptr, [&Ran]() { Ran.Add(TEXT("Low")); });
+		UGGDeferredWorkSubsystem::Submit(World, EGGDeferredWorkPriority::Normal, nullptr, [&Ran, World]()
+		{
+			Ran.Add(TEXT("Normal"));
+			UGGDeferredWorkSubsystem::Submit(World, EGGDeferredWorkPriority::High, nullptr, [&Ran]() { Ran.Add(TEXT("Nested High")); });
+		});
+		UGGDeferredWorkSubsystem::Submit(World, EGGDeferredWorkPriority::High, nullptr, [&Ran]() { Ran.Add(TEXT("High")); });
+
+		TestEqual(TEXT("Nothing runs on submit"), Ran.Num(), 0);
+		DeferredWork->Flush();
+
+		TestEqual(TEXT("Run order"), FString::Join(Ran, TEXT(", ")), FString(TEXT("High, Normal, Nested High, Low")));
+		for (int32 PriorityIndex = 0; PriorityIndex < static_cast<int32>(EGGDeferredWorkPriority::MAX); ++PriorityIndex)
+		{
+			TestEqual(TEXT("Queue depth after flush"),
+				DeferredWork->GetQueueDepth(static_cast<EGGDeferredWorkPriority>(PriorityIndex)), 0);
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
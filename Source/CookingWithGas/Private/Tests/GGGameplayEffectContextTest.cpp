@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGGameplayEffectContext.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGGGameplayEffectContextHitZoneTest, "CookingWithGas.GameplayEffectContext.HitZone",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+/**
+ *  Round-trips a context through NetSerialize. The hit zone sits on the tenth rep bit, past
+ *  the first byte, so it only survives if every rep bit is written and read back.
+ */
+bool FGGGameplayEffectContextHitZoneTest::RunTest(const FString& Parameters)
+{
+	FGGGameplayEffectContext Source;
+	Source.SetIsCriticalHit(true);
+	Source.SetIsLuckyHit(true);
+	Source.SetHitZone(3);
+
+	FBitWriter Writer(0, true);
+	bool bSaved = false;
+	Source.NetSerialize(Writer, nullptr, bSaved);
+	TestTrue(TEXT("Context was written"), bSaved && !Writer.IsError());
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	FGGGameplayEffectContext Loaded;
+	bool bLoaded = false;
+	Loaded.NetSerialize(Reader, nullptr, bLoaded);
+	TestTrue(TEXT("Context was read"), bLoaded && !Reader.IsError());
+
+	TestEqual(TEXT("Hit zone"), Loaded.GetHitZone(), static_cast<uint8>(3));
+	TestTrue(TEXT("Critical hit"), Loaded.IsCriticalHit());
+	TestTrue(TEXT("Lucky hit"), Loaded.IsLuckyHit());
+
+	// A context without a zone clears the zone of the one it is read into
+	FGGGameplayEffectContext NoZone;
+	FBitWriter NoZoneWriter(0, true);
+	NoZone.NetSerialize(NoZoneWriter, nullptr, bSaved);
+	FBitReader NoZoneReader(NoZoneWriter.GetData(), NoZoneWriter.GetNumBits());
+	Loaded.NetSerialize(NoZoneReader, nullptr, bLoaded);
+	TestEqual(TEXT("Hit zone cleared"), Loaded.GetHitZone(), static_cast<uint8>(0));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
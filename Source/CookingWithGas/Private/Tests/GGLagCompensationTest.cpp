@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GGLagCompensationSubsystem.h"
+#include "GGCharacterBase.h"
+#include "GGTestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGGLagCompensationRewindTest, "CookingWithGas.LagCompensation.Rewind",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+/**
+ *  Moves a character between two samples and checks a hit on its old position: the hit is
+ *  accepted when rewound to the time of the first sample, and rejected against the present.
+ */
+bool FGGLagCompensationRewindTest::RunTest(const FString& Parameters)
+{
+	FGGTestWorld TestWorld;
+	UWorld* World = TestWorld.World;
+
+	UGGLagCompensationSubsystem* LagCompensation = World->GetSubsystem<UGGLagCompensationSubsystem>();
+	AGGCharacterBase* Character = World->SpawnActor<AGGCharacterBase>(FVector::ZeroVector, FRotator::ZeroRotator);
+	if (TestNotNull(TEXT("Subsystem"), LagCompensation) && TestNotNull(TEXT("Character"), Character))
+	{
+		LagCompensation->RegisterCharacter(Character);
+
+		const FVector OldLocation(0.f, 0.f, 100.f);
+		const FVector NewLocation(500.f, 0.f, 100.f);
+
+		World->TimeSeconds = 1.0;
+		Character->SetActorLocation(OldLocation);
+		LagCompensation->Tick(0.f);
+
+		World->TimeSeconds = 1.1;
+		Character->SetActorLocation(NewLocation);
+		LagCompensation->Tick(0.f);
+
+		FHitResult Hit;
+		Hit.ImpactPoint = OldLocation;
+
+		TestEqual(TEXT("Hit on the old position, rewound"),
+			LagCompensation->ValidateHit(Character, Hit, 1.0), EGGHitValidation::Body);
+		TestEqual(TEXT("Hit on the old position, in the present"),
+			LagCompensation->ValidateHit(Character, Hit, 1.1), EGGHitValidation::Miss);
+
+		Hit.ImpactPoint = NewLocation;
+		TestEqual(TEXT("Hit on the new position, in the present"),
+			LagCompensation->ValidateHit(Character, Hit, 1.1), EGGHitValidation::Body);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Game world for automation tests, with its own world context so world subsystems are created
+ * and actors can be spawned. Destroyed, with its context, when the fixture goes out of scope.
+ */
+struct FGGTestWorld
+{
+	FGGTestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+	}
+
+	~FGGTestWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	FGGTestWorld(const FGGTestWorld&) = delete;
+	FGGTestWorld& operator=(const FGGTestWorld&) = delete;
+
+	UWorld* World = nullptr;
+};
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AbilitySystemComponent.h"
+
+#include "GGAbilitySystemComponent.generated.h"
+
+struct FGGActorMemoryFootprint;
+
+// Offense attributes of a source, evaluated once for one damage type and target tag set and reused by every hit
+struct COOKINGWITHGAS_API FGGOffenseSnapshot
+{
+	float CriticalChance	 = 0.f;
+	float CriticalMultiplier = 1.f;
+	float LuckyChance		 = 0.f;
+	float DamageAdd			 = 0.f;
+	float DamageMulti		 = 1.f;
+};
+
+/**
+ * Project ability system component. Used by every AGGCharacterBase and AGGDestructible.
+ */
+UCLASS(ClassGroup = AbilitySystem, meta = (BlueprintSpawnableComponent))
+class COOKINGWITHGAS_API UGGAbilitySystemComponent : public UAbilitySystemComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGAbilitySystemComponent();
+
+	// Allows activation, target data and end ability RPCs to be sent as one ServerAbilityRPCBatch
+	virtual bool ShouldDoServerAbilityRPCBatch() const override { return true; }
+
+	// Activates abilities bound to the input; abilities that batch their RPCs are activated in a batch scope
+	virtual void AbilityLocalInputPressed(int32 InputID) override;
+
+	// Releases abilities bound to the input, found through the input table
+	virtual void AbilityLocalInputReleased(int32 InputID) override;
+
+	// Ticks only while something needs it: a ticking ability task, a montage to replicate or a
+	// tickable attribute set. Effects and cooldowns run on timers and never need the tick.
+	virtual bool GetShouldTick() const override;
+	virtual void BeginPlay() override;
+
+	// Wakes the tick so the montage's replicated info is kept up to date while it plays
+	virtual float PlayMontage(UGameplayAbility* AnimatingAbility, FGameplayAbilityActivationInfo ActivationInfo,
+							  UAnimMontage* Montage, float InPlayRate, FName StartSectionName = NAME_None,
+							  float StartTimeSeconds = 0.0f) override;
+
+	// Tries to activate the ability while batching every server RPC it sends until the scope ends.
+	// If bEndAbilityImmediately is set, the ability is ended inside the same batch.
+	bool BatchRPCTryActivateAbility(FGameplayAbilitySpecHandle AbilityHandle, bool bEndAbilityImmediately = false);
+
+	// Same as AbilityLocalInputPressed, for abilities bound through UGGGameplayAbility::InputTag;
+	// bound from the input actions in ACookingWithGasCharacter::AbilityInputTagActions
+	void AbilityInputTagPressed(const FGameplayTag& InputTag);
+
+	// Same as AbilityLocalInputReleased, for abilities bound through UGGGameplayAbility::InputTag
+	void AbilityInputTagReleased(const FGameplayTag& InputTag);
+
+	// Returns the handles of every ability granted with the given input ID
+	TConstArrayView<FGameplayAbilitySpecHandle> GetAbilityHandlesForInput(int32 InputID) const;
+
+	// Constant time replacement for FindAbilitySpecFromHandle
+	FGameplayAbilitySpec* FindAbilitySpecFromHandleFast(FGameplayAbilitySpecHandle Handle);
+	const FGameplayAbilitySpec* FindAbilitySpecFromHandleFast(FGameplayAbilitySpecHandle Handle) const;
+
+	// Offense attributes for damage of the given type (a Damage.Type tag, or none) against a target
+	// with the given tags, evaluated with this component's owned tags plus the damage type. Cached
+	// per damage type and target tag set until one of the attributes, one of their modifiers or an
+	// owned tag changes.
+	const FGGOffenseSnapshot& GetOffenseSnapshot(const FGameplayTag& DamageType, const FGameplayTagContainer* TargetTags = nullptr);
+
+	// Adds this component, its attribute sets, granted specs and active effects to the footprint.
+	// Effect contexts found in CountedContexts are skipped, new ones are added to it.
+	void AccumulateMemoryFootprint(FGGActorMemoryFootprint& Footprint, TSet<const FGameplayEffectContext*>& CountedContexts) const;
+
+protected:
+
+	// Keeps the input tables up to date; called on the server and on clients when specs replicate
+	virtual void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	virtual void OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+
+	// Input press logic shared by input IDs and input tags
+	void PressAbilitySpecInput(FGameplayAbilitySpec& Spec);
+	void ReleaseAbilitySpecInput(FGameplayAbilitySpec& Spec);
+
+	using FAbilityHandleList = TArray<FGameplayAbilitySpecHandle, TInlineAllocator<2>>;
+
+	// Input ID to the abilities granted with it, so input dispatch does not scan every granted ability
+	TMap<int32, FAbilityHandleList> InputIDToAbilityHandles;
+
+	// Input tag to the abilities bound to it
+	TMap<FGameplayTag, FAbilityHandleList> InputTagToAbilityHandles;
+
+	// Last known position of each spec in ActivatableAbilities.Items; verified on every lookup
+	mutable TMap<FGameplayAbilitySpecHandle, int32> AbilitySpecIndices;
+
+	// Drops every cached offense snapshot
+	void InvalidateOffenseSnapshots();
+	void OnOffenseAggregatorDirty(FAggregator* Aggregator);
+	void OnOffenseTagChanged(const FGameplayTag Tag, int32 NewCount);
+
+	struct FOffenseSnapshotEntry
+	{
+		FGameplayTag DamageType;
+		FGameplayTagContainer TargetTags;
+		FGGOffenseSnapshot Snapshot;
+	};
+
+	// Offense snapshots by damage type and target tags; few enough that a linear search is the fastest lookup
+	TArray<FOffenseSnapshotEntry> OffenseSnapshots;
+
+	// True once the offense aggregators and tag changes invalidate the snapshots
+	bool bOffenseSnapshotsBound = false;
+};
@@ -15,6 +15,64 @@
 	GAMEPLAYATTRIBUTE_VALUE_SETTER(PropertyName) \
 	GAMEPLAYATTRIBUTE_VALUE_INITTER(PropertyName)
 
+/**
+ * Every attribute of UGGAttributeSet with its replication and clamp rule: X(Name, bReplicated, ClampRule).
+ * Accessors, rep-notifies, replication registration and clamping are all generated from this list.
+ * The UPROPERTY and OnRep_ declarations still have to be written in the class, since the header
+ * tool does not expand macros; leaving one out is a compile error. Attributes that are not
+ * replicated have no OnRep_.
+ *
+ * Clamp rules:
+ *	GG_NO_CLAMP							The attribute is never clamped
+ *	GG_CLAMP_TO_RANGE(Min, Max)			Clamped to a constant range
+ *	GG_CLAMP_TO_ATTRIBUTE(Min, MaxName)	Clamped between Min and another attribute, and clamped
+ *										again whenever that attribute drops below it
+ */
+#define GG_ATTRIBUTE_LIST(X) \
+	X(Health,				true,	GG_CLAMP_TO_ATTRIBUTE(0.f, HealthMax)) \
+	X(HealthMax,			true,	GG_NO_CLAMP) \
+	X(Armor,				true,	GG_CLAMP_TO_ATTRIBUTE(0.f, ArmorMax)) \
+	X(ArmorMax,				true,	GG_NO_CLAMP) \
+	X(InDamage,				false,	GG_NO_CLAMP) \
+	X(CriticalChance,		true,	GG_NO_CLAMP) \
+	X(CriticalMultiplier,	true,	GG_NO_CLAMP) \
+	X(LuckyChance,			true,	GG_NO_CLAMP) \
+	X(DamageAdd,			true,	GG_NO_CLAMP) \
+	X(DamageMulti,			true,	GG_NO_CLAMP) \
+	X(Ammo,					true,	GG_NO_CLAMP) \
+	X(Chilled,				true,	GG_CLAMP_TO_RANGE(0.f, 100.f)) \
+	X(DeChill,				true,	GG_CLAMP_TO_RANGE(0.f, 100.f))
+
+// Index of each attribute in GG_ATTRIBUTE_LIST
+enum class EGGAttribute : uint8
+{
+#define GG_ATTRIBUTE_ENUM(Name, bReplicated, ClampRule) Name,
+	GG_ATTRIBUTE_LIST(GG_ATTRIBUTE_ENUM)
+#undef GG_ATTRIBUTE_ENUM
+	Count
+};
+
+static_assert(static_cast<int32>(EGGAttribute::Count) <= 32, "Dependent attributes are stored in a 32 bit mask");
+
+// How an attribute is clamped whenever it changes
+struct FGGAttributeClampRule
+{
+	enum class EType : uint8 { None, Range, Attribute };
+
+	EType Type = EType::None;
+	float Min  = 0.f;
+	float Max  = 0.f;
+	EGGAttribute MaxAttribute = EGGAttribute::Count;
+};
+
+#define GG_NO_CLAMP FGGAttributeClampRule{}
+#define GG_CLAMP_TO_RANGE(MinValue, MaxValue) \
+	FGGAttributeClampRule{ FGGAttributeClampRule::EType::Range, MinValue, MaxValue }
+#define GG_CLAMP_TO_ATTRIBUTE(MinValue, MaxName) \
+	FGGAttributeClampRule{ FGGAttributeClampRule::EType::Attribute, MinValue, 0.f, EGGAttribute::MaxName }
+
+#define GG_ATTRIBUTE_ACCESSORS(Name, bReplicated, ClampRule) ATTRIBUTE_ACCESSORS(UGGAttributeSet, Name)
+
 DECLARE_MULTICAST_DELEGATE_FourParams(FGGAttributeEvent,
 	AActor*,						// Effect Instigator (what called the effect)
 	AActor*,						// Effect Causer (what dun it)
@@ -42,75 +100,78 @@ public:
 	
 	UGGAttributeSet();
 
+	// Getters, setters and initters for every attribute in GG_ATTRIBUTE_LIST
+	GG_ATTRIBUTE_LIST(GG_ATTRIBUTE_ACCESSORS)
+
+	// Returns the attribute for an index of GG_ATTRIBUTE_LIST
+	static const FGameplayAttribute& GetAttribute(EGGAttribute Index);
+
+	// Returns the index of the attribute in GG_ATTRIBUTE_LIST, or EGGAttribute::Count if it is not part of this set
+	static EGGAttribute GetAttributeIndex(const FGameplayAttribute& Attribute);
+
 	// This attribute is for tracking the entity's current health value
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_Health, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData Health;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, Health);
 
 	// Tracking the entity's maximum health value; Used for clamping.
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_HealthMax, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData HealthMax;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, HealthMax);
 	
 	// This attribute is for tracking the entity's current armor value
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_Armor, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData Armor;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, Armor);
 
 	// Tracking the entity's maximum armor value; Used for clamping.
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_ArmorMax, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData ArmorMax;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, ArmorMax);
 
 	// Tracks the damage coming in, so it can be manipulated before being applied
-	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
-		ReplicatedUsing=OnRep_InDamage, Meta = (AllowPrivateAccess = true))
+	// Only used on the server while an effect executes, so it is not replicated
+	UPROPERTY(BlueprintReadOnly, Category = "Attributes", Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData InDamage;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, InDamage);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_CriticalChance, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData CriticalChance;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, CriticalChance);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_CriticalMultiplier, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData CriticalMultiplier;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, CriticalMultiplier);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_LuckyChance, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData LuckyChance;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, LuckyChance);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_DamageAdd, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData DamageAdd;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, DamageAdd);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_DamageMulti, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData DamageMulti;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, DamageMulti);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_Ammo, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData Ammo;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, Ammo);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_Chilled, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData Chilled;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, Chilled);
 
 	UPROPERTY(BlueprintReadOnly, Category = "Attributes",
 		ReplicatedUsing=OnRep_DeChill, Meta = (AllowPrivateAccess = true))
 	FGameplayAttributeData DeChill;
-	ATTRIBUTE_ACCESSORS(UGGAttributeSet, DeChill);
+
+	// Splits incoming damage between armor and health, armor first.
+	// Acid damage is stronger against armor, fire damage is stronger against health.
+	// Returns true if any of the damage made it through to health.
+	static bool ResolveIncomingDamage(float InDamage, bool bIsAcidDamage, bool bIsFireDamage,
+									  float ArmorMax, float HealthMax,
+									  float& InOutArmor, float& InOutHealth);
 
 	mutable FGGAttributeEvent OnOutOfHealth; // Used to bind listeners for when health runs out
 	mutable FGGAttributeEvent OnOutOfArmor;  // Used to bind listeners for when armor runs out
@@ -134,10 +195,6 @@ protected:
 	UFUNCTION()
 	virtual void OnRep_ArmorMax(const FGameplayAttributeData& OldArmorMaxData);
 
-	// Triggers notification after damage coming in has been changed via network replication
-	UFUNCTION()
-	virtual void OnRep_InDamage(const FGameplayAttributeData& OldInDamage);
-
 	// Triggers notification after critical chance has been changed via network replication
 	UFUNCTION()
 	virtual void OnRep_CriticalChance(const FGameplayAttributeData& OldCriticalChance);
@@ -177,6 +234,8 @@ protected:
 
 	virtual void ClampAttributeOnChange(const FGameplayAttribute& Attribute, float& NewValue) const;
 
+	virtual void PostAttributeChange(const FGameplayAttribute& Attribute, float OldValue, float NewValue) override;
+
 	virtual void PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data) override;
 
 	
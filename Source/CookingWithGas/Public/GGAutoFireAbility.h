@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Abilities/GameplayAbilityTargetTypes.h"
+#include "GGGameplayAbility.h"
+
+#include "GGAutoFireAbility.generated.h"
+
+class UGameplayEffect;
+
+// A single shot fired by the client, as sent to the server for validation
+USTRUCT(BlueprintType)
+struct COOKINGWITHGAS_API FGGShotInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	FVector_NetQuantize Origin;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ability")
+	FVector_NetQuantizeNormal Direction;
+
+	// Increases by one for every shot of an activation; lets the server detect gaps and duplicates
+	UPROPERTY()
+	uint16 ShotNumber = 0;
+};
+
+/**
+ * Target data holding every shot fired since the last network update,
+ * so several shots cost a single target data RPC.
+ */
+USTRUCT(BlueprintType)
+struct COOKINGWITHGAS_API FGGTargetData_Shots : public FGameplayAbilityTargetData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FGGShotInfo> Shots;
+
+	virtual UScriptStruct* GetScriptStruct() const override { return FGGTargetData_Shots::StaticStruct(); }
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGGTargetData_Shots> : public TStructOpsTypeTraitsBase2<FGGTargetData_Shots>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Native base for sustained fire abilities, such as GA_Projectile_AutoFire.
+ *
+ * The locally controlled client generates shots at FireRate and sends them in batches,
+ * one target data RPC per BatchInterval. The first batch is sent together with the activation,
+ * and the last one together with the end of the ability. The server validates every shot
+ * (fire rate, origin and cost) before calling FireShot.
+ */
+UCLASS(Abstract, Blueprintable)
+class COOKINGWITHGAS_API UGGAutoFireAbility : public UGGGameplayAbility
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGAutoFireAbility();
+
+	// Shots per second while the input is held
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire", meta = (ClampMin = "0.1"))
+	float FireRate = 10.f;
+
+	// How often pending shots are sent to the server, in seconds. Higher fire rates
+	// send several shots per batch instead of one RPC per shot.
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire", meta = (ClampMin = "0.0"))
+	float BatchInterval = 0.05f;
+
+	// Upper bound of shots in a single batch, to bound RPC size after a hitch
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire", meta = (ClampMin = "1"))
+	int32 MaxShotsPerBatch = 8;
+
+	// Projectile spawned by the default FireShot implementation
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire")
+	TSubclassOf<AActor> ProjectileClass;
+
+	// If set, ProjectileClass is not replicated and clients spawn this instead (see UGGShotEventSubsystem)
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire")
+	TSubclassOf<AActor> CosmeticProjectileClass;
+
+	// Offset from the view point to the muzzle, along the view direction
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire")
+	float MuzzleOffset = 100.f;
+
+	// The effect the projectile applies on hit, handed to it through IGGProjectileInterface
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire|Damage")
+	TSubclassOf<UGameplayEffect> DamageEffect;
+
+	// Damage passed to the effect through the Damage.SetByCaller magnitude
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire|Damage")
+	float Damage = 0.f;
+
+	// Damage type added to the damage spec, such as Damage.Type.Fire
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire|Damage", meta = (Categories = "Damage.Type"))
+	FGameplayTag DamageTypeTag;
+
+	// How far, in units, a shot origin may be from the avatar before the server rejects it
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire|Validation")
+	float MaxOriginError = 300.f;
+
+	// Extra time, in seconds, granted to the client when validating its fire rate
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Auto Fire|Validation")
+	float FireRateTolerance = 0.15f;
+
+	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle,
+								 const FGameplayAbilityActorInfo* ActorInfo,
+								 const FGameplayAbilityActivationInfo ActivationInfo,
+								 const FGameplayEventData* TriggerEventData) override;
+
+	virtual void InputReleased(const FGameplayAbilitySpecHandle Handle,
+							   const FGameplayAbilityActorInfo* ActorInfo,
+							   const FGameplayAbilityActivationInfo ActivationInfo) override;
+
+	virtual void EndAbility(const FGameplayAbilitySpecHandle Handle,
+							const FGameplayAbilityActorInfo* ActorInfo,
+							const FGameplayAbilityActivationInfo ActivationInfo,
+							bool bReplicateEndAbility, bool bWasCancelled) override;
+
+protected:
+
+	// Called on the server for every validated shot. Spawns ProjectileClass by default, with the
+	// damage spec; the projectile is simulated on the server, so its hits are not client-reported.
+	UFUNCTION(BlueprintNativeEvent, Category = "Auto Fire")
+	void FireShot(const FVector& Origin, const FVector& Direction);
+
+	// Called on the shooting client for every shot it sends, for muzzle flashes and sounds
+	UFUNCTION(BlueprintImplementableEvent, Category = "Auto Fire")
+	void OnShotPredicted(const FVector& Origin, const FVector& Direction);
+
+	// Where the next shot starts and where it goes. Uses the avatar's view point by default.
+	virtual void GetShotOriginAndDirection(FVector& OutOrigin, FVector& OutDirection) const;
+
+	// Server-side checks for a single client shot
+	virtual bool ValidateShot(const FGGShotInfo& Shot);
+
+private:
+
+	// Client: generates the shots owed since the last batch and sends them in one RPC
+	void SendPendingShots();
+
+	// Server: receives a batch of shots from the client
+	void OnServerShotsReceived(const FGameplayAbilityTargetDataHandle& Data, FGameplayTag ActivationTag);
+
+	FTimerHandle BatchTimer;
+	FDelegateHandle TargetDataDelegateHandle;
+
+	// Client: fractional shots accumulated between batches
+	float PendingShots = 0.f;
+	double LastBatchTime = 0.0;
+	uint16 NextShotNumber = 0;
+
+	// Server: used to validate the fire rate of the client
+	double ServerActivationTime = 0.0;
+	int32 ServerShotsAccepted = 0;
+	uint16 LastServerShotNumber = 0;
+};
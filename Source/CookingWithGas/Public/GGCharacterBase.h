@@ -7,16 +7,19 @@
 #include "Logging/LogMacros.h"
 #include "AbilitySystemInterface.h"
 #include "GameplayEffectTypes.h"
+#include "GGDeathPresentationSubsystem.h"
 #include "GGGameplayAbility.h"
+#include "GGLagCompensationSubsystem.h"
 #include "InputActionValue.h"
 #include "Delegates/Delegate.h"
-#include "Camera/CameraComponent.h"
-#include "GameFramework/SpringArmComponent.h"
 
 #include "GGCharacterBase.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCharacterBase, Log, All);
 
+class UCameraComponent;
+class USpringArmComponent;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAttributeUpdated,
 const FGameplayAttribute&, AttributeData, const float, NewValue);
 
@@ -39,13 +42,16 @@ public:
 	UPROPERTY(BlueprintAssignable) FOnArmorDepleted		OnArmorDepleted;
 	UPROPERTY(BlueprintAssignable) FOnDamageTaken		OnDamage;
 
+	// Declared here so Blueprints and widgets can read them from any character, but only
+	// created by player characters (see ACookingWithGasCharacter); null on enemies
+
 	/** Camera boom positioning the camera behind the character */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	USpringArmComponent* CameraBoom;
+	USpringArmComponent* CameraBoom = nullptr;
 
 	/** Follow camera */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	UCameraComponent* FollowCamera;
+	UCameraComponent* FollowCamera = nullptr;
 
 	// Returns the AbilitySystemComponent so it can be made private
 	virtual UAbilitySystemComponent* GetAbilitySystemComponent() const override;
@@ -59,12 +65,67 @@ public:
 	class UGGAttributeSet* AttributeSet;
 
 	// An array of default abilities on spawn, set within blueprint
+	// Soft references, loaded ahead of the spawn by UGGPreloadSubsystem
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "GAS")
+	TArray<TSoftClassPtr<class UGGGameplayAbility> > DefaultAbilities;
+
+	// Data-only projectile abilities granted on spawn, each with the data asset as its source object
 	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "GAS")
-	TArray<TSubclassOf <class UGGGameplayAbility> > DefaultAbilities;
+	TArray<TObjectPtr<class UGGProjectileAbilityData> > DefaultProjectileAbilities;
 
 	// An array of default effects on spawn, set within blueprint
+	// Soft references, loaded ahead of the spawn by UGGPreloadSubsystem
 	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "GAS")
-	TArray<TSubclassOf <class UGameplayEffect> > DefaultEffects;
+	TArray<TSoftClassPtr<class UGameplayEffect> > DefaultEffects;
+
+	// Where the last damage taken hit this character; set right before OnDamageTaken is called
+	UPROPERTY(BlueprintReadOnly, Category = "GAS")
+	FVector LastDamageLocation = FVector::ZeroVector;
+
+	// Hit zone of HitZones the last damage taken landed in, 0 if none; set with LastDamageLocation
+	UPROPERTY(BlueprintReadOnly, Category = "GAS")
+	uint8 LastDamageHitZone = 0;
+
+	// Called on clients for each hit batched by UGGHitFeedbackSubsystem; fires OnDamage and OnDamageTaken
+	void ReceiveHitFeedback(const struct FGGHitFeedbackEvent& Event);
+
+	// Baked death animations, one picked at random when the ragdoll budget is full
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Death")
+	TArray<TObjectPtr<class UAnimationAsset> > DeathAnimations;
+
+	UFUNCTION(BlueprintPure, Category = "Death")
+	bool IsDead() const { return DeathPose.bIsDead; }
+
+	// True between death and the deferred OnOutOfHealth event; the corpse is kept until it has run
+	bool IsDeathEventPending() const { return bDeathEventPending; }
+
+	// Shows the damage of a hit caused by the local player on this character's health and armor
+	// right away, until the server's values confirm it or the prediction expires. Client only.
+	// Nothing calls this yet: projectile hits are detected in Blueprint, and a projectile's local
+	// hit handler has to call it for hits caused by the local player before prediction shows.
+	// @param Damage The hit's base damage; the instigator's DamageAdd and DamageMulti are applied
+	UFUNCTION(BlueprintCallable, Category = "GAS|Prediction")
+	void PredictDamage(AActor* DamageInstigator, float Damage, FGameplayTag DamageType);
+
+	// Health and armor as shown on this machine, including predicted damage
+	UFUNCTION(BlueprintPure, Category = "GAS|Prediction")
+	float GetDisplayedHealth() const { return DisplayedHealth; }
+
+	UFUNCTION(BlueprintPure, Category = "GAS|Prediction")
+	float GetDisplayedArmor() const { return DisplayedArmor; }
+
+	// Head, torso and limb zones of this character's skeleton; without it, only "head" hits are special
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Damage")
+	TObjectPtr<class UGGHitZoneData> HitZones;
+
+	// The hit zone ID of the bone, 0 if it has none; see UGGHitZoneData
+	uint8 GetHitZoneId(FName BoneName) const;
+
+	// Bones the server keeps a history of, so hits claiming them can be checked at the shooter's view time
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	TArray<FGGRewindBone> RewindBones;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	
 
 protected:
@@ -72,7 +133,10 @@ protected:
 	virtual void PossessedBy(AController* NewController) override;
 
 	virtual void InitializeAbilities(); // Sets up default abilities
-	virtual void InitializeEffects();	// Sets up default effects
+	virtual void InitializeEffects();	// Sets up default effects, on a later frame
+
+	// Applies the default effects right away
+	void ApplyDefaultEffects();
 
 	virtual void OnRep_PlayerState() override;
 	
@@ -145,19 +209,108 @@ protected:
 	// Called when an ability input has been triggered
 	void OnFireAbility(const FInputActionValue& Value);
 
+	// Called when an ability input has been released or canceled
+	void OnFireAbilityReleased(const FInputActionValue& Value);
+
+	// Called when an input action bound to an ability input tag has been pressed
+	void OnAbilityInputTagPressed(FGameplayTag InputTag);
+
+	// Called when an input action bound to an ability input tag has been released or canceled
+	void OnAbilityInputTagReleased(FGameplayTag InputTag);
+
 	// Sends the input action to the AbilitySystemComponent
 	virtual void SendAbilityLocalInput(const FInputActionValue& Value, int32 InputID);
 
+	// Forwards only press/release edges of an ability input to the AbilitySystemComponent.
+	// Presses that arrive while the bound ability is on cooldown or still active get buffered.
+	virtual void SetAbilityInputPressed(int32 InputID, bool bPressed);
+
+	// True if every ability bound to the input is currently active or unable to activate
+	bool IsAbilityInputBlocked(int32 InputID) const;
+
+	// Retries buffered presses, dropping the ones that have expired
+	void FlushBufferedAbilityInput();
+
+	// How long, in seconds, a press is kept when its ability cannot activate yet
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Input)
+	float AbilityInputBufferTime = 0.2f;
+
+	// How often buffered presses are retried while any are pending
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Input)
+	float AbilityInputBufferRetryInterval = 1.f / 30.f;
+
+	static_assert(static_cast<int32>(EAbilityInputID::MAX) <= 32, "Ability input state is stored in a 32 bit mask");
+
+	// One bit per EAbilityInputID that is currently held down
+	uint32 AbilityInputHeldMask = 0;
+
+	// One bit per EAbilityInputID with a buffered press waiting for its ability
+	uint32 AbilityInputBufferedMask = 0;
+
+	// One bit per EAbilityInputID still held after its buffered press expired; its release is dropped too
+	uint32 AbilityInputExpiredMask = 0;
+
+	// World time at which each buffered press is dropped
+	float AbilityInputBufferExpiry[static_cast<int32>(EAbilityInputID::MAX)] = {};
+
+	FTimerHandle AbilityInputBufferTimer;
+
+	// Zone ID of each bone of the mesh, resolved from HitZones in BeginPlay
+	TSharedPtr<const TArray<uint8>> BoneHitZones;
+
+	// A locally caused hit whose damage is shown before the server confirms it
+	struct FPredictedHit
+	{
+		TWeakObjectPtr<AActor> Instigator;
+		float Damage = 0.f;
+		bool bIsAcidDamage = false;
+		bool bIsFireDamage = false;
+		// Earliest time replicated vitals can include the hit: the prediction time plus a round trip
+		double ConfirmTime = 0.0;
+		double ExpireTime = 0.0;
+	};
+
+	// Oldest first
+	TArray<FPredictedHit> PredictedHits;
+
+	// Health and armor last shown to widgets, through OnAttributeUpdated and OnHealthChanged/OnArmorChanged
+	float DisplayedHealth = 0.f;
+	float DisplayedArmor = 0.f;
+
+	FTimerHandle PredictedHitExpiryTimer;
+
+	// Shows the server's health and armor with the pending predicted hits resolved on top
+	void RefreshDisplayedVitals();
+
+	// Removes the oldest pending prediction of the instigator, confirmed by the server
+	void AcknowledgePredictedHit(const AActor* DamageInstigator);
+
+	// Removes the predictions that replicated health or armor has had time to include
+	void ConfirmPredictedHits();
+
+	// Rolls back the predictions the server never confirmed in time
+	void ExpirePredictedHits();
+
+	// Where the character came to rest when it died; the only part of a death that replicates
+	UPROPERTY(ReplicatedUsing = OnRep_DeathPose)
+	FGGDeathRestingPose DeathPose;
+
+	UFUNCTION()
+	void OnRep_DeathPose();
+
 	// True when the inputs have been bound for the AbilitySystemComponent
 	// False indicates the input for abilities has not initialized
 	bool bIsInputBound = false;
 
+	// Set while the OnOutOfHealth event waits in the deferred work queue
+	bool bDeathEventPending = false;
+
 public:
 	
-	/** Returns CameraBoom subobject **/
+	/** Returns CameraBoom subobject, null on characters without a camera **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	
-	/** Returns FollowCamera subobject **/
+	/** Returns FollowCamera subobject, null on characters without a camera **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
 };
 
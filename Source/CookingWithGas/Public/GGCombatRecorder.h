@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GGEffectDamageCalc.h"
+
+#include "GGCombatRecorder.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatRecorder, Log, All);
+
+class UAbilitySystemComponent;
+struct FGameplayEffectSpec;
+
+// The kinds of entries that can be found in a combat recording stream
+enum class EGGCombatRecordType : uint8
+{
+	ActorName	= 0,	// Maps a compact actor ID to the actor's name and class
+	EffectName	= 1,	// Maps a compact effect ID to the effect class path
+	Damage		= 2,	// A single damage application, see FGGCombatDamageRecord
+};
+
+// Bit flags stored with each damage record
+namespace GGCombatRecordFlags
+{
+	enum : uint8
+	{
+		Critical	= 1 << 0,
+		Lucky		= 1 << 1,
+		Headshot	= 1 << 2,
+		AcidDamage	= 1 << 3,
+		FireDamage	= 1 << 4,
+	};
+}
+
+/**
+ * Everything needed to replay one damage application offline: who hit whom,
+ * with which effect, the captured magnitudes, the random seed of the roll and
+ * the target's vitality right before the hit.
+ */
+struct COOKINGWITHGAS_API FGGCombatDamageRecord
+{
+	float  WorldTime	= 0.f;
+	uint32 SourceID		= 0;
+	uint32 TargetID		= 0;
+	uint32 EffectID		= 0;
+	float  EffectLevel	= 1.f;
+	int32  RandomSeed	= 0;
+	uint8  Flags		= 0;
+
+	float InDamage			 = 0.f;
+	float CriticalChance	 = 0.f;
+	float CriticalMultiplier = 0.f;
+	float LuckyChance		 = 0.f;
+
+	float TargetHealth		= 0.f;
+	float TargetHealthMax	= 0.f;
+	float TargetArmor		= 0.f;
+	float TargetArmorMax	= 0.f;
+
+	// The damage the calculation produced when this was recorded
+	float OutDamage = 0.f;
+
+	// Rebuilds the inputs that were handed to UGGEffectDamageCalc::RollDamage
+	FGGDamageRollInputs GetRollInputs() const;
+
+	friend FArchive& operator<<(FArchive& Ar, FGGCombatDamageRecord& Record);
+};
+
+/**
+ * Reads back a stream written by UGGCombatRecorder.
+ * Name entries are consumed internally and can be looked up by ID.
+ */
+class COOKINGWITHGAS_API FGGCombatRecordReader
+{
+public:
+
+	// Loads the whole recording into memory; returns false if it is not a valid recording
+	bool Open(const FString& FilePath);
+
+	// Returns the next damage record, false once the end of the stream is reached
+	bool ReadNext(FGGCombatDamageRecord& OutRecord);
+
+	// Starts reading from the first record again
+	void Rewind();
+
+	const FString& GetActorName(uint32 ActorID) const;
+	const FString& GetEffectName(uint32 EffectID) const;
+
+private:
+
+	TArray<uint8> Data;
+	int64 FirstRecordOffset = 0;
+	int64 Offset = 0;
+
+	TMap<uint32, FString> ActorNames;
+	TMap<uint32, FString> EffectNames;
+};
+
+/**
+ * Optional server-side recorder for every damage application that goes through
+ * UGGEffectDamageCalc. Records are written to a compact, append-only binary stream
+ * under Saved/CombatRecordings and can be replayed with the GGCombatReplay commandlet.
+ *
+ * Controlled with gg.CombatRecord.Start / gg.CombatRecord.Stop, or automatically
+ * on every game world with gg.CombatRecord.AutoStart=1.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGCombatRecorder : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static constexpr uint32 StreamMagic	  = 0x52434747; // 'GGCR'
+	static constexpr uint16 StreamVersion = 1;
+
+	// Returns the recorder of the world the given object lives in, if any
+	static UGGCombatRecorder* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Opens a new recording file. An empty name generates one from the current time.
+	bool StartRecording(const FString& RecordingName = FString());
+
+	// Flushes and closes the current recording, if any
+	void StopRecording();
+
+	bool IsRecording() const { return FileWriter.IsValid(); }
+
+	// Appends one damage application to the stream. Only records on the server.
+	void RecordDamage(const UAbilitySystemComponent* SourceComponent,
+					  const UAbilitySystemComponent* TargetComponent,
+					  const FGameplayEffectSpec& EffectSpec,
+					  const FGGDamageRollInputs& RollInputs,
+					  int32 RandomSeed, bool bIsCritical, bool bIsLucky, float OutDamage);
+
+private:
+
+	uint32 GetActorID(const AActor* Actor);
+	uint32 GetEffectID(const UObject* EffectDef);
+
+	// Writes the pending buffer to disk
+	void Flush();
+
+	TUniquePtr<FArchive> FileWriter;
+	FString FilePath;
+
+	// Records are serialized here first and written to disk in large chunks
+	TArray<uint8> PendingBytes;
+	int64 BytesWritten = 0;
+
+	TMap<FObjectKey, uint32> ActorIDs;
+	TMap<FObjectKey, uint32> EffectIDs;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "GGCombatReplayCommandlet.generated.h"
+
+/**
+ * Replays a combat recording written by UGGCombatRecorder through the damage roll of
+ * UGGEffectDamageCalc and the damage resolution of UGGAttributeSet, without a world.
+ * Reports any hit that no longer produces the recorded damage, plus timings for profiling.
+ *
+ * Usage: -run=GGCombatReplay -File=<path.ggrec> [-Loops=N] [-NoResync] [-Verbose]
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGCombatReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGCombatReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
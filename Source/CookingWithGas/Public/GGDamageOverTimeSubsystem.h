@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "GGDamageOverTimeSubsystem.generated.h"
+
+class UAbilitySystemComponent;
+class UGameplayEffect;
+
+/**
+ * Server-side ledger of every damage over time source (burns, acid, damage areas).
+ *
+ * Sources on the same target are merged by damage type and instigator, so twenty burns
+ * from one player cost a single damage execution per tick instead of twenty. All targets
+ * tick on one shared schedule every gg.DamageOverTime.Interval seconds. Each source is
+ * filed under the tick it expires on, so expiring sources never needs a scan.
+ *
+ * Damage is applied with the source's damage effect, so it still runs through
+ * UGGEffectDamageCalc and UGGAttributeSet, and kill credit and OnDamageTaken keep the instigator.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGDamageOverTimeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Adds a damage over time source to the target. Server only.
+	 * @param Target The actor taking damage; must have an ability system component
+	 * @param Instigator Who gets credit for the damage
+	 * @param DamageCauser The actor that caused the damage, such as a projectile or damage area
+	 * @param DamageType Damage type tag, such as Damage.Type.Fire
+	 * @param DamagePerTick Damage dealt every tick
+	 * @param Duration How long the source lasts, in seconds
+	 * @param DamageEffect Instant effect applied each tick; receives the damage through Damage.SetByCaller.
+	 *					   Merged sources all tick with the effect and causer of the latest one.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GAS|Damage", meta = (DefaultToSelf = "DamageCauser"))
+	static bool AddDamageOverTime(AActor* Target, AActor* Instigator, AActor* DamageCauser,
+								  FGameplayTag DamageType, float DamagePerTick, float Duration,
+								  TSubclassOf<UGameplayEffect> DamageEffect);
+
+	// Removes every source on the target; AGGCharacterBase calls it when the character dies
+	UFUNCTION(BlueprintCallable, Category = "GAS|Damage")
+	static void ClearDamageOverTime(AActor* Target);
+
+	// Total damage per tick currently applied to the target
+	UFUNCTION(BlueprintPure, Category = "GAS|Damage")
+	static float GetDamagePerTick(const AActor* Target);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	// All sources of one damage type and instigator on one target, merged together
+	using FDotEntryKey = TPair<FGameplayTag, FObjectKey>;
+
+	struct FDotEntry
+	{
+		FDotEntryKey Key;
+		FGameplayTag DamageType;
+		TWeakObjectPtr<AActor> Instigator;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TSubclassOf<UGameplayEffect> DamageEffect;
+		float DamagePerTick = 0.f;
+		int32 Sources = 0;
+	};
+
+	struct FDotLedger
+	{
+		TWeakObjectPtr<UAbilitySystemComponent> Target;
+
+		// Lets expirations filed for a cleared ledger be told apart from a new one
+		uint32 Generation = 0;
+
+		// Sparse so indices held by pending expirations stay valid
+		TSparseArray<FDotEntry> Entries;
+		TMap<FDotEntryKey, int32> EntryIndices;
+	};
+
+	// A source that stops contributing to its entry once its tick has been applied
+	struct FDotExpiry
+	{
+		FObjectKey LedgerKey;
+		uint32 LedgerGeneration = 0;
+		int32 EntryIndex = 0;
+		float DamagePerTick = 0.f;
+	};
+
+	void AddSource(UAbilitySystemComponent* TargetComponent, AActor* Instigator, AActor* DamageCauser,
+				   FGameplayTag DamageType, float DamagePerTick, float Duration,
+				   TSubclassOf<UGameplayEffect> DamageEffect);
+
+	// Applies one tick of every ledger, then expires the sources that ended on this tick
+	void ProcessTick();
+
+	void ApplyEntry(UAbilitySystemComponent* TargetComponent, const FDotEntry& Entry) const;
+
+	void ExpireSource(const FDotExpiry& Expiry);
+
+	// Ledgers keyed by the target ability system component
+	TMap<FObjectKey, FDotLedger> Ledgers;
+
+	// Tick index to the sources that expire after that tick
+	TMap<int64, TArray<FDotExpiry>> ExpiryBuckets;
+
+	uint32 NextLedgerGeneration = 1;
+	int64  CurrentTick = 0;
+	double NextTickTime = 0.0;
+};
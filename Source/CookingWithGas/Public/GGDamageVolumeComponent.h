@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
+
+#include "GGDamageVolumeComponent.generated.h"
+
+class UAbilitySystemComponent;
+class UGameplayEffect;
+
+/**
+ * Makes its owner, such as BP_DamageArea, apply an effect to everything inside it on a fixed pulse.
+ * The owner's collision decides what is inside: it needs to generate overlap events.
+ *
+ * Occupants are tracked on the server from the owner's begin and end overlap events, so pulses
+ * never query overlaps. Pulses are fired by UGGDamageVolumeSubsystem while the volume is occupied;
+ * each one builds a single effect spec and applies it to every occupant.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class COOKINGWITHGAS_API UGGDamageVolumeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGDamageVolumeComponent();
+
+	// Instant effect applied to every occupant on each pulse
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage Volume")
+	TSubclassOf<UGameplayEffect> PulseEffect;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage Volume")
+	float EffectLevel = 1.f;
+
+	// Passed to the effect through the Damage.SetByCaller magnitude; 0 or less to leave it unset
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage Volume")
+	float DamagePerPulse = 0.f;
+
+	// Damage type added to the pulse spec, such as Damage.Type.Acid
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage Volume", meta = (Categories = "Damage.Type"))
+	FGameplayTag DamageTypeTag;
+
+	// Seconds between two pulses. Pulses land on multiples of it in world time, so volumes with
+	// the same interval pulse in the same frame.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage Volume", meta = (ClampMin = "0.05"))
+	float PulseInterval = 1.f;
+
+	// Actors currently inside that have an ability system component. Server only.
+	UFUNCTION(BlueprintPure, Category = "Damage Volume")
+	int32 GetOccupantCount() const { return Occupants.Num(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Damage Volume")
+	void GetOccupants(TArray<AActor*>& OutOccupants) const;
+
+	// Applies the pulse effect to every occupant; called by UGGDamageVolumeSubsystem
+	void Pulse();
+
+	// World time of the next pulse, set by UGGDamageVolumeSubsystem while the volume is occupied
+	double NextPulseTime = 0.0;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION()
+	void OnOwnerBeginOverlap(AActor* OverlappedActor, AActor* OtherActor);
+
+	UFUNCTION()
+	void OnOwnerEndOverlap(AActor* OverlappedActor, AActor* OtherActor);
+
+private:
+
+	struct FOccupant
+	{
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UAbilitySystemComponent> AbilitySystem;
+		FObjectKey Key;
+	};
+
+	void AddOccupant(AActor* Actor);
+	void RemoveOccupantAt(int32 Index);
+
+	TArray<FOccupant> Occupants;
+
+	// Occupant actor to its index in Occupants
+	TMap<FObjectKey, int32> OccupantIndices;
+};
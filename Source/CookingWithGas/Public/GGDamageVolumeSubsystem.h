@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GGDamageVolumeSubsystem.generated.h"
+
+class UGGDamageVolumeComponent;
+
+/**
+ * Fires the pulses of every occupied UGGDamageVolumeComponent, on the server. Volumes are only
+ * known here while something is inside them, so empty hazard fields cost nothing, and an
+ * occupied one costs a single pulse per interval however many actors stand in it.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGDamageVolumeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Starts pulsing the volume, on the next multiple of its pulse interval
+	void ActivateVolume(UGGDamageVolumeComponent* Volume);
+
+	// Stops pulsing the volume, such as when its last occupant leaves
+	void DeactivateVolume(UGGDamageVolumeComponent* Volume);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	TArray<TWeakObjectPtr<UGGDamageVolumeComponent>> ActiveVolumes;
+};
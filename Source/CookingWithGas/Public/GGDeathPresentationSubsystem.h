@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GGDeathPresentationSubsystem.generated.h"
+
+class AGGCharacterBase;
+
+// Where a dead character comes to rest; worked out by the server without simulating anything
+USTRUCT()
+struct COOKINGWITHGAS_API FGGDeathRestingPose
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	bool bIsDead = false;
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	float Yaw = 0.f;
+};
+
+/**
+ * Presents character deaths within a budget, so a mass kill does not leave dozens of bodies
+ * simulating at once.
+ *
+ * Up to gg.Death.MaxRagdolls deaths become physics ragdolls; the others play one of the
+ * character's baked DeathAnimations. A ragdoll that has settled, or has simulated for
+ * gg.Death.MaxRagdollTime seconds, is frozen into a static pose and frees its slot. Enemy
+ * corpses beyond gg.Death.MaxCorpses or older than gg.Death.CorpseLifetime are removed oldest
+ * first, but never before their deferred OnOutOfHealth event has run; player characters are
+ * never removed here.
+ *
+ * Dedicated servers never simulate ragdolls; they only replicate the resting pose and remove
+ * old corpses.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGDeathPresentationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Works out where the character comes to rest and stops its movement and collision. Server only.
+	static FGGDeathRestingPose MakeRestingPose(AGGCharacterBase* Character);
+
+	// Starts presenting the death of the character; called on the server and on clients
+	void HandleDeath(AGGCharacterBase* Character);
+
+	// Ragdolls currently simulating
+	int32 GetActiveRagdollCount() const { return ActiveRagdolls.Num(); }
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	struct FRagdoll
+	{
+		TWeakObjectPtr<AGGCharacterBase> Character;
+		double StartTime = 0.0;
+
+		// World time since which the body has been slower than gg.Death.SettleSpeed; 0 while moving
+		double SettledSince = 0.0;
+	};
+
+	struct FCorpse
+	{
+		TWeakObjectPtr<AGGCharacterBase> Character;
+		double DeathTime = 0.0;
+	};
+
+	void StartRagdoll(AGGCharacterBase* Character);
+	void PlayDeathAnimation(AGGCharacterBase* Character);
+	void FreezeRagdoll(AGGCharacterBase* Character);
+	void RemoveCorpse(AGGCharacterBase* Character);
+
+	// Removes expired corpses and those beyond the cap, keeping any whose death event is still pending
+	void CullCorpses(double Now);
+
+	// True where deaths are shown; false on dedicated servers
+	bool ShouldPresent() const;
+
+	TArray<FRagdoll> ActiveRagdolls;
+
+	// Oldest first
+	TArray<FCorpse> Corpses;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GGDeferredWorkSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDeferredWork, Log, All);
+
+DECLARE_DYNAMIC_DELEGATE(FGGDeferredWorkDelegate);
+
+// Order in which deferred work runs when the frame budget cannot cover every queue
+UENUM(BlueprintType)
+enum class EGGDeferredWorkPriority : uint8
+{
+	// Gameplay setup that should land within a frame or two, such as default effects
+	High,
+	// Presentation and cleanup, such as death events and destructible teardown
+	Normal,
+	// Anything that can wait, such as pickup respawns and widgets
+	Low,
+	MAX UMETA(Hidden)
+};
+
+/**
+ * Runs non-urgent gameplay work spread over frames instead of on the frame it was triggered,
+ * so a whole wave dying at once does not cost one frame the cleanup of every enemy.
+ *
+ * Work runs in priority order, first in first out within a priority, until
+ * gg.DeferredWork.BudgetMs is spent. At least one item runs every frame, and an item that has
+ * waited longer than the max wait of its priority runs regardless of the budget, so low
+ * priority work is delayed but never starved. Work still queued when the world begins tearing
+ * down is flushed, while its actors are still there. gg.DeferredWork.Stats lists queue depths and latencies.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGDeferredWorkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UGGDeferredWorkSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Queues work for a later frame. Runs it right away if the world has no scheduler.
+	 * @param WorldContextObject Any object of the world the work belongs to
+	 * @param Priority The queue the work goes to
+	 * @param Owner If set, the work is dropped when the owner is gone by the time it runs
+	 * @param Work The work itself
+	 */
+	static void Submit(const UObject* WorldContextObject, EGGDeferredWorkPriority Priority,
+					   const UObject* Owner, TUniqueFunction<void()>&& Work);
+
+	// Queues a Blueprint event for a later frame; dropped if the event's object is gone by then
+	UFUNCTION(BlueprintCallable, Category = "Deferred Work", meta = (WorldContext = "WorldContextObject"))
+	static void SubmitDeferredWork(const UObject* WorldContextObject, EGGDeferredWorkPriority Priority,
+								   FGGDeferredWorkDelegate Work);
+
+	// Items waiting in the queue of the given priority
+	UFUNCTION(BlueprintPure, Category = "Deferred Work")
+	int32 GetQueueDepth(EGGDeferredWorkPriority Priority) const;
+
+	// Writes the depth and latency of each queue to the output
+	void LogStats(FOutputDevice& Ar) const;
+
+	// Runs every queued item regardless of the budget, including work submitted while flushing
+	void Flush();
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	struct FWorkItem
+	{
+		TUniqueFunction<void()> Work;
+		TWeakObjectPtr<const UObject> Owner;
+		bool bHasOwner = false;
+		double SubmitTime = 0.0;
+	};
+
+	struct FWorkQueue
+	{
+		// First in first out; items before Head have already run
+		TArray<FWorkItem> Items;
+		int32 Head = 0;
+
+		int32 Num() const { return Items.Num() - Head; }
+
+		// Stats since the world began; latencies are in seconds
+		int64  Submitted = 0;
+		int64  Executed = 0;
+		int64  Dropped = 0;
+		int64  Overdue = 0;
+		int32  PeakDepth = 0;
+		double TotalLatency = 0.0;
+		double MaxLatency = 0.0;
+	};
+
+	void OnWorldBeginTearDown(UWorld* World);
+
+	// Runs the oldest item of the queue and updates its stats
+	void RunNext(int32 PriorityIndex, double Now, bool bOverdue);
+
+	// Seconds an item of the given priority may wait before it ignores the budget
+	static double GetMaxWait(int32 PriorityIndex);
+
+	FWorkQueue Queues[static_cast<int32>(EGGDeferredWorkPriority::MAX)];
+
+	FDelegateHandle WorldBeginTearDownHandle;
+};
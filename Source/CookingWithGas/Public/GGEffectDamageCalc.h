@@ -7,6 +7,19 @@
 
 #include "GGEffectDamageCalc.generated.h"
 
+/**
+ * The captured values that a single damage roll is calculated from.
+ * Kept free of any engine state so the roll can be replayed offline.
+ */
+struct COOKINGWITHGAS_API FGGDamageRollInputs
+{
+	float InDamage			 = 0.f;
+	float CriticalChance	 = 0.f;
+	float CriticalMultiplier = 0.f;
+	float LuckyChance		 = 0.f;
+	bool  bIsHeadshot		 = false;
+};
+
 /**
  * To utilize this in the project, add this UGGEffectDamageCalc to your
  * Gameplay Effect execution array.
@@ -24,6 +37,11 @@ public:
 		const FGameplayEffectCustomExecutionParameters& ExecutionParams,
 		FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const override;
 
+	// Rolls critical and lucky hits for the given inputs and returns the modified damage.
+	// Deterministic for a given random stream seed.
+	static float RollDamage(const FGGDamageRollInputs& Inputs, FRandomStream& RandomStream,
+							bool& bOutIsCritical, bool& bOutIsLucky);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName InDamageTag = FName("Damage.SetByCaller");
 	
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GGCharacterBase.h"
+#include "GGThreatTable.h"
 
 #include "GGEnemyCharacter.generated.h"
 
@@ -21,8 +22,76 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category = "GAS")
 	void OnChilledChanged(float OldValue, float NewValue);
 
+	// If false, this enemy always keeps full detail movement
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement LOD")
+	bool bAllowMovementLOD = true;
+
+	// Seconds between two movement updates while in low detail movement
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement LOD", meta = (ClampMin = "0"))
+	float MovementLODTickInterval = 0.1f;
+
+	// Net update frequency while in low detail movement
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement LOD", meta = (ClampMin = "0.1"))
+	float MovementLODNetUpdateFrequency = 2.f;
+
+	// How long the enemy counts as in combat after taking damage or EnterCombat, in seconds
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Movement LOD")
+	float CombatDuration = 5.f;
+
+	// Switches the enemy to full detail movement, and keeps it there for CombatDuration. Server only.
+	UFUNCTION(BlueprintCallable, Category = "Movement LOD")
+	void EnterCombat();
+
+	bool IsInCombat(double WorldTime) const { return WorldTime - LastCombatTime < CombatDuration; }
+
+	UFUNCTION(BlueprintPure, Category = "Movement LOD")
+	bool IsMovementLOD() const { return bMovementLOD; }
+
+	// Low detail movement walks on the navmesh without floor sweeps, updates less often and
+	// replicates less often. Called by UGGMovementLODSubsystem.
+	void SetMovementLOD(bool bLowDetail);
+
+	// Seconds for threat to halve; 0 or less for threat that never decays
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Threat")
+	float ThreatHalfLife = 10.f;
+
+	// Instigators whose threat decays under this are forgotten
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Threat", meta = (ClampMin = "0"))
+	float MinThreat = 1.f;
+
+	// The living instigator that caused this enemy the most threat, if any. Server only.
+	UFUNCTION(BlueprintPure, Category = "Threat")
+	AActor* GetTopThreat() const;
+
+	// Current threat of the instigator against this enemy. Server only.
+	UFUNCTION(BlueprintPure, Category = "Threat")
+	float GetThreat(const AActor* Instigator) const;
+
+	// Adds threat without damage, such as for taunts. Damage taken adds its magnitude as threat. Server only.
+	UFUNCTION(BlueprintCallable, Category = "Threat")
+	void AddThreat(AActor* Instigator, float Threat);
+
+	UFUNCTION(BlueprintCallable, Category = "Threat")
+	void ClearThreat();
+
 protected:
 
 	virtual void BeginPlay() override;
 
+	// Taking damage puts the enemy in combat and adds threat to the instigator
+	virtual void OnDamageTakenChanged(AActor* DamageInstigator,
+									  AActor* DamageCauser,
+									  const FGameplayTagContainer& DamageTags,
+									  float DamageMagnitude, bool isCritical, bool isLucky) override;
+
+	bool bMovementLOD = false;
+
+	// Net update frequency to restore when leaving low detail movement
+	float FullDetailNetUpdateFrequency = 0.f;
+
+	double LastCombatTime = -UE_BIG_NUMBER;
+
+	// Not replicated; threat is only kept on the server
+	FGGThreatTable ThreatTable;
+
 };
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "GameplayEffectTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+
+#include "GGExplosionSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogExplosion, Log, All);
+
+// Describes a single blast for UGGExplosionSubsystem
+USTRUCT(BlueprintType)
+struct COOKINGWITHGAS_API FGGExplosionParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion")
+	FVector Origin = FVector::ZeroVector;
+
+	// Anything beyond this distance is not damaged
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion")
+	float Radius = 500.f;
+
+	// Anything within this distance takes full damage
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion")
+	float InnerRadius = 100.f;
+
+	// Damage scale at the outer radius
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float MinDamageScale = 0.2f;
+
+	// Shapes the falloff between the inner and outer radius; 1 is linear
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion", meta = (ClampMin = "0.01"))
+	float FalloffExponent = 1.f;
+
+	// Victims behind anything that blocks this channel are not damaged
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion")
+	TEnumAsByte<ECollisionChannel> OcclusionChannel = ECC_Visibility;
+
+	// Applied to every victim, scaled through the Damage.Falloff set by caller magnitude
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion")
+	FGameplayEffectSpecHandle DamageSpec;
+
+	// The grenade or projectile that exploded; ignored by occlusion traces, like the instigator of the spec
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Explosion")
+	TObjectPtr<AActor> DamageCauser = nullptr;
+};
+
+/**
+ * Resolves explosion damage with line of sight and distance falloff, without stalling
+ * the game thread. Candidates are gathered with one overlap, sorted by distance, and
+ * checked with async line traces. Victims never shield each other; only the world does.
+ * At most gg.Explosion.TracesPerFrame traces are issued per frame, so very large blasts
+ * are spread over a couple of frames, always in the same order. Damage is applied when
+ * the trace results come back.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGExplosionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Starts resolving an explosion. Server only; returns false on clients.
+	UFUNCTION(BlueprintCallable, Category = "GAS|Explosion", meta = (WorldContext = "WorldContextObject"))
+	static bool Explode(const UObject* WorldContextObject, const FGGExplosionParams& Params);
+
+	// Damage scale for a victim at the given distance from the origin
+	static float GetDamageScale(const FGGExplosionParams& Params, float Distance);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	struct FPendingExplosion
+	{
+		FGGExplosionParams Params;
+		TArray<TWeakObjectPtr<AActor>> Victims;
+		// Ignores the damage causer, the instigator and every victim, so only the world occludes
+		FCollisionQueryParams QueryParams;
+		int32 TracesRemaining = 0;
+	};
+
+	struct FPendingTrace
+	{
+		uint32 ExplosionID	= 0;
+		int32  VictimIndex	= 0;
+	};
+
+	bool AddExplosion(const FGGExplosionParams& Params);
+
+	void OnTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	void ApplyDamage(const FPendingExplosion& Explosion, AActor* Victim) const;
+
+	void FinishTrace(uint32 ExplosionID);
+
+	TMap<uint32, FPendingExplosion> Explosions;
+
+	// Traces waiting for budget, in the order they will be issued
+	TArray<FPendingTrace> QueuedTraces;
+	int32 QueuedTraceHead = 0;
+
+	// Traces in flight, indexed by the trace user data
+	TSparseArray<FPendingTrace> InFlightTraces;
+
+	FTraceDelegate TraceDelegate;
+	uint32 NextExplosionID = 1;
+};
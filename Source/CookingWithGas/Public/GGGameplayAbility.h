@@ -14,5 +14,14 @@ public:
 
 	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Ability")
 	EAbilityInputID AbilityInputID { EAbilityInputID::None };
+
+	// Optional input tag, for inputs that are not part of EAbilityInputID
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Ability", meta = (Categories = "Input"))
+	FGameplayTag InputTag;
+
+	// When activated from input, sends activation, target data and end ability
+	// to the server as a single batched RPC (see UGGAbilitySystemComponent)
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Ability")
+	bool bBatchServerRPCs = false;
 	
 };
@@ -19,6 +19,18 @@ public:
 	bool IsCriticalHit() const { return bIsCriticalHit; }
 	bool IsLuckyHit() const { return bIsLuckyHit; }
 
+	// The hit zone of the target that was hit, 0 if none; see UGGHitZoneData
+	void SetHitZone(uint8 InHitZone) { HitZone = InHitZone; }
+	uint8 GetHitZone() const { return HitZone; }
+
+	// How far behind the server, in seconds, the shooter saw targets when it fired; see
+	// UGGLagCompensationSubsystem. Kept as a delay rather than a time, so a projectile that
+	// flies for a while is still rewound by the shooter's latency when it lands.
+	// Not replicated: set by the server when it accepts a shot from a client.
+	void SetHitViewDelay(float InHitViewDelay) { HitViewDelay = InHitViewDelay; bHasHitViewDelay = true; }
+	bool HasHitViewDelay() const { return bHasHitViewDelay; }
+	float GetHitViewDelay() const { return HitViewDelay; }
+
 	// Mandatory child override - Returns the actual struct used for serialization
 	virtual UScriptStruct* GetScriptStruct() const override;
 
@@ -35,4 +47,10 @@ protected:
 
 	UPROPERTY()
 	bool bIsLuckyHit = false;
+
+	UPROPERTY()
+	uint8 HitZone = 0;
+
+	float HitViewDelay = 0.f;
+	bool bHasHitViewDelay = false;
 };
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Engine/NetSerialization.h"
+#include "GGWorldReplicator.h"
+
+#include "GGHitFeedbackSubsystem.generated.h"
+
+struct FGameplayEffectSpec;
+
+// One hit as seen by clients: enough to show floating text, the crit/lucky flash and the damage radial
+USTRUCT()
+struct COOKINGWITHGAS_API FGGHitFeedbackEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TWeakObjectPtr<AActor> Target;
+
+	UPROPERTY()
+	TWeakObjectPtr<AActor> Instigator;
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	// Sent as a half float
+	UPROPERTY()
+	float Magnitude = 0.f;
+
+	// The Damage.Type tag of the hit, if any
+	UPROPERTY()
+	FGameplayTag DamageType;
+
+	// The hit zone of the target that was hit, 0 if none; see UGGHitZoneData
+	UPROPERTY()
+	uint8 HitZone = 0;
+
+	UPROPERTY()
+	bool bIsCritical = false;
+
+	UPROPERTY()
+	bool bIsLucky = false;
+};
+
+// Every hit of one server frame, packed into a single RPC parameter
+USTRUCT()
+struct COOKINGWITHGAS_API FGGHitFeedbackBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FGGHitFeedbackEvent> Events;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGGHitFeedbackBatch> : public TStructOpsTypeTraitsBase2<FGGHitFeedbackBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Always relevant actor spawned by UGGHitFeedbackSubsystem on the server, used to send hit batches.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class COOKINGWITHGAS_API AGGHitFeedbackReplicator : public AGGWorldReplicator
+{
+	GENERATED_BODY()
+
+public:
+
+	// Unpacked on clients into AGGCharacterBase::ReceiveHitFeedback. Events whose target
+	// is not relevant to a connection resolve to a null target there and are skipped.
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastHitFeedback(const FGGHitFeedbackBatch& Batch);
+};
+
+/**
+ * Server-side batcher for hit feedback. Damage taken by characters is queued during the
+ * frame and sent to clients as one unreliable multicast at the end of it, instead of each
+ * hit replicating its own effect context and hit result.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGHitFeedbackSubsystem : public UGGWorldReplicatorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGHitFeedbackSubsystem();
+
+	// Queues the hit for clients. Does nothing on clients and in standalone games.
+	static void AddHit(AActor* Target, const FGameplayEffectSpec& DamageSpec, float Magnitude);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	TGGEventBatcher<FGGHitFeedbackBatch> PendingEvents;
+};
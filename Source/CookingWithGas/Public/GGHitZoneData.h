@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/ObjectKey.h"
+
+#include "GGHitZoneData.generated.h"
+
+class USkeletalMesh;
+class USkeleton;
+
+// A part of the body, such as the head, torso or a limb, that changes the damage of hits on it
+USTRUCT(BlueprintType)
+struct COOKINGWITHGAS_API FGGHitZone
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zone")
+	FName ZoneName;
+
+	// Bones of the zone; their child bones belong to it too, unless another zone lists them
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zone")
+	TArray<FName> Bones;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zone", meta = (InlineEditConditionToggle))
+	bool bOverrideCriticalChance = false;
+
+	// Replaces the attacker's critical chance for hits on this zone, in percent
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zone",
+		meta = (EditCondition = "bOverrideCriticalChance", ClampMin = "0", ClampMax = "100"))
+	float CriticalChance = 100.f;
+
+	// Applied to the damage of hits on this zone, before the critical roll
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zone", meta = (ClampMin = "0"))
+	float DamageMultiplier = 1.f;
+};
+
+/**
+ * The hit zones of one skeleton, referenced by AGGCharacterBase::HitZones.
+ *
+ * Zones are identified by a one byte ID: the zone's index plus one, 0 meaning no zone. When a
+ * character registers its mesh, the zones are resolved into one zone ID per bone of the mesh,
+ * shared by every character with that mesh, so a hit only costs an indexed lookup.
+ */
+UCLASS(BlueprintType)
+class COOKINGWITHGAS_API UGGHitZoneData : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	// The skeleton the bone names refer to; bones missing from it fail data validation
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zones")
+	TObjectPtr<USkeleton> Skeleton;
+
+	// At most 255 zones
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Hit Zones")
+	TArray<FGGHitZone> Zones;
+
+	// Zone ID of each bone of the mesh, by bone index; built on the first call for each mesh
+	TSharedPtr<const TArray<uint8>> GetBoneZones(const USkeletalMesh* Mesh) const;
+
+	// The zone with the given ID, or null for 0 and unknown IDs
+	const FGGHitZone* GetZone(uint8 ZoneId) const
+	{
+		return ZoneId > 0 && Zones.IsValidIndex(ZoneId - 1) ? &Zones[ZoneId - 1] : nullptr;
+	}
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+#endif
+
+private:
+
+	mutable TMap<TObjectKey<USkeletalMesh>, TSharedPtr<const TArray<uint8>>> BoneZonesByMesh;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffectTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "GGLagCompensationSubsystem.generated.h"
+
+class AGGCharacterBase;
+
+// A bone whose position is kept for hit validation, checked as a sphere around the bone
+USTRUCT(BlueprintType)
+struct COOKINGWITHGAS_API FGGRewindBone
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	FName BoneName;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation", meta = (ClampMin = "0"))
+	float Radius = 15.f;
+};
+
+// Outcome of checking a hit against where the target was at the shooter's view time
+enum class EGGHitValidation : uint8
+{
+	// The target has no history; the hit cannot be checked
+	NotTracked,
+	// The impact is outside the target's capsule
+	Miss,
+	// The impact is on the capsule, but not on the bone the hit claims
+	Body,
+	// The impact is on the capsule; the claimed bone has no history, so it is not checked
+	BoneNotTracked,
+	// The impact is on the claimed bone, which is one of the target's rewind bones
+	Bone,
+};
+
+/**
+ * Server-side lag compensation. Every server tick, the capsule position and the rewind bones
+ * of each character are written to a per-character ring buffer covering
+ * gg.LagCompensation.MaxRewindMs.
+ *
+ * A hit is validated by rewinding the target to the time the shooter saw: first a cheap test of
+ * the impact against the rewound capsule, then, only for hits that claim a rewind bone (such as
+ * the head), a test against the rewound bone.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UGGLagCompensationSubsystem* Get(const UObject* WorldContextObject);
+
+	// Starts keeping the history of the character; called on the server when it begins play
+	void RegisterCharacter(AGGCharacterBase* Character);
+
+	/**
+	 * Checks a hit against the target as it was at the view time.
+	 * @param Target The actor that was hit
+	 * @param Hit The hit; its impact point and bone name are checked
+	 * @param ViewTime World time the shooter saw when the hit was made
+	 */
+	EGGHitValidation ValidateHit(const AActor* Target, const FHitResult& Hit, double ViewTime) const;
+
+	// How far behind the server the shooter currently sees the other characters: its ping and
+	// interpolation delay, in seconds. 0 for shooters controlled on the server.
+	float GetShooterViewDelay(const AActor* Shooter) const;
+
+	// Marks a hit that the shooter's client claimed, so the damage execution also validates it
+	// where the target was at the shooter's view time. Hits found on the server are not marked.
+	void MarkClientReportedHit(FGameplayEffectContextHandle& Context, const AActor* Shooter) const;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	// Samples are stored in flat arrays so one character costs a few allocations at most
+	struct FRewindHistory
+	{
+		TWeakObjectPtr<AGGCharacterBase> Character;
+		FObjectKey Key;
+
+		float CapsuleRadius = 0.f;
+		float CapsuleHalfHeight = 0.f;
+
+		TArray<FName, TInlineAllocator<2>> BoneNames;
+		TArray<float, TInlineAllocator<2>> BoneRadii;
+
+		// Ring buffer of Capacity samples; Newest is the index of the latest one
+		TArray<float> Times;
+		TArray<FVector3f> CapsuleLocations;
+		// Capacity * BoneNames.Num() positions, sample major
+		TArray<FVector3f> BoneLocations;
+		int32 Newest = INDEX_NONE;
+		int32 Count = 0;
+	};
+
+	void Sample(FRewindHistory& History, float Time) const;
+
+	// Finds the two samples around the time and the blend between them; false if there are none
+	bool FindSamples(const FRewindHistory& History, float Time, int32& OutOlder, int32& OutNewer, float& OutAlpha) const;
+
+	TArray<FRewindHistory> Histories;
+	TMap<FObjectKey, int32> HistoryIndices;
+
+	// Samples kept per character
+	int32 Capacity = 0;
+};
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMemoryReport, Log, All);
+
+class AActor;
+class UWorld;
+struct FGameplayEffectContext;
+
+// The parts of an actor that a memory footprint is broken down into
+enum class EGGMemoryCategory : uint8
+{
+	Actor,				// The actor object and its components, except the ones below
+	AbilitySystem,		// The ability system component and its input tables
+	AttributeSets,		// Every attribute set spawned by the ability system component
+	AbilitySpecs,		// Granted ability specs and their ability instances
+	ActiveEffects,		// Active gameplay effects and their specs
+	EffectContexts,		// Effect contexts of the active effects, including their hit result copies
+	Cameras,			// Camera and spring arm components
+
+	Count
+};
+
+/**
+ * Bytes owned by one actor, broken down by EGGMemoryCategory.
+ * Objects are counted by their shallow size plus the containers they allocate;
+ * shared data such as meshes, ability CDOs and effect definitions is not counted.
+ */
+struct COOKINGWITHGAS_API FGGActorMemoryFootprint
+{
+	FString ActorName;
+	FName	ClassName;
+
+	uint64 Bytes[static_cast<int32>(EGGMemoryCategory::Count)] = {};
+
+	int32 NumAbilitySpecs	 = 0;
+	int32 NumActiveEffects	 = 0;
+	int32 NumEffectContexts	 = 0;
+
+	uint64& operator[](EGGMemoryCategory Category) { return Bytes[static_cast<int32>(Category)]; }
+	uint64  operator[](EGGMemoryCategory Category) const { return Bytes[static_cast<int32>(Category)]; }
+
+	uint64 GetTotal() const;
+
+	// Adds the bytes and counts of another footprint to this one
+	void Accumulate(const FGGActorMemoryFootprint& Other);
+
+	static const TCHAR* GetCategoryName(EGGMemoryCategory Category);
+};
+
+/**
+ * Memory footprint of every live AGGCharacterBase and AGGDestructible of a world.
+ * Gathered by the gg.MemoryReport console command and the GGMemoryReport commandlet.
+ */
+struct COOKINGWITHGAS_API FGGMemoryReport
+{
+	TArray<FGGActorMemoryFootprint> Actors;
+
+	// Walks the world and measures each actor; effect contexts shared between actors are counted once
+	static FGGMemoryReport Gather(UWorld* World);
+
+	// Measures a single actor. Contexts already in CountedContexts are skipped, new ones are added.
+	static FGGActorMemoryFootprint Measure(const AActor* Actor, TSet<const FGameplayEffectContext*>& CountedContexts);
+
+	// Logs the totals and the per class breakdown, and optionally every actor
+	void Log(FOutputDevice& Ar, bool bPerActor) const;
+
+	// Writes one row per actor, one per class and one for the total
+	bool WriteCSV(const FString& FilePath) const;
+
+	// Saved/Profiling/MemoryReports/<WorldName>-<date>.csv
+	static FString GetDefaultCSVPath(const UWorld* World);
+
+private:
+
+	// Per class totals, largest first
+	TArray<FGGActorMemoryFootprint> GetClassTotals(TArray<int32>& OutActorCounts) const;
+};
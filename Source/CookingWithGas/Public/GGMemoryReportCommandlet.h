@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "GGMemoryReportCommandlet.generated.h"
+
+/**
+ * Loads each map, begins play with the map's game mode, possesses every character with its
+ * default controller so abilities and startup effects are granted, and writes the memory
+ * footprint of its characters and destructibles, see FGGMemoryReport.
+ *
+ * Usage: -run=GGMemoryReport -Map=<map>[+<map>...] [-CSVDir=<directory>] [-Actors]
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGMemoryReportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGMemoryReportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
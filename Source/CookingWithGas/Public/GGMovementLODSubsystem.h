@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GGMovementLODSubsystem.generated.h"
+
+class AGGEnemyCharacter;
+
+/**
+ * Server-side movement LOD for enemies. Every gg.MovementLOD.Interval seconds, each enemy is
+ * checked against the player pawns: enemies further than gg.MovementLOD.Distance from all of
+ * them, and out of combat, switch to their low detail movement (see AGGEnemyCharacter::SetMovementLOD).
+ * They switch back once a player comes within gg.MovementLOD.Distance * gg.MovementLOD.Hysteresis,
+ * or right away when they enter combat.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGMovementLODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// Starts managing the enemy's movement LOD; called on the server when it begins play
+	void RegisterEnemy(AGGEnemyCharacter* Enemy);
+
+	// Enemies currently in low detail movement
+	int32 GetLowDetailCount() const;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	void UpdateEnemies();
+
+	TArray<TWeakObjectPtr<AGGEnemyCharacter>> Enemies;
+
+	double NextUpdateTime = 0.0;
+};
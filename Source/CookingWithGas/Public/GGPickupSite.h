@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+
+#include "GGPickupSite.generated.h"
+
+class UGameplayEffect;
+
+/**
+ * A place in the level where players pick up a gameplay effect, such as health, armor or a buff.
+ *
+ * Sites have no collision, tick or replication of their own: UGGPickupSubsystem checks players
+ * against nearby sites, applies the effect and toggles availability through one replicated
+ * bitfield. Sites must be placed in the level, so server and clients index them the same way.
+ */
+UCLASS(Blueprintable)
+class COOKINGWITHGAS_API AGGPickupSite : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AGGPickupSite();
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickup")
+	TObjectPtr<UStaticMeshComponent> Mesh;
+
+	// Applied to the player that picks this up
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pickup")
+	TSubclassOf<UGameplayEffect> PickupEffect;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pickup")
+	float EffectLevel = 1.f;
+
+	// How close a player has to get, in world units
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pickup", meta = (ClampMin = "0"))
+	float PickupRadius = 100.f;
+
+	// Seconds before the pickup is available again; 0 or less to never come back
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pickup")
+	float RespawnTime = 30.f;
+
+	UFUNCTION(BlueprintPure, Category = "Pickup")
+	bool IsAvailable() const { return bAvailable; }
+
+	// Shows or hides the pickup; called by UGGPickupSubsystem on the server and on clients
+	void SetAvailable(bool bNewAvailable);
+
+	// Server only: called after the effect has been applied to the pawn
+	UFUNCTION(BlueprintImplementableEvent, Category = "Pickup")
+	void OnPickedUp(APawn* Pawn);
+
+	// Called on the server and on clients when the pickup is taken or comes back
+	UFUNCTION(BlueprintImplementableEvent, Category = "Pickup")
+	void OnAvailabilityChanged(bool bIsAvailable);
+
+private:
+
+	bool bAvailable = true;
+};
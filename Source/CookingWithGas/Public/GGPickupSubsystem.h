@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GGWorldReplicator.h"
+
+#include "GGPickupSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPickup, Log, All);
+
+class AGGPickupSite;
+
+/**
+ * Always relevant actor spawned by UGGPickupSubsystem on the server. Holds one bit per pickup
+ * site, so taking or respawning a pickup replicates a single word.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class COOKINGWITHGAS_API AGGPickupAvailability : public AGGWorldReplicator
+{
+	GENERATED_BODY()
+
+public:
+
+	AGGPickupAvailability();
+
+	// Bit N is set while the site with index N is available
+	UPROPERTY(ReplicatedUsing = OnRep_AvailableBits)
+	TArray<uint32> AvailableBits;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+
+	UFUNCTION()
+	void OnRep_AvailableBits();
+};
+
+/**
+ * Runs every AGGPickupSite of the world. Sites are filed in a 2D grid under each cell their
+ * radius touches, so each player pawn only looks at the sites of its own cell, every
+ * gg.Pickup.CheckInterval seconds. Taken sites come back through a respawn queue ordered by time.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGPickupSubsystem : public UGGWorldReplicatorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGPickupSubsystem();
+
+	// Shows or hides every site according to the replicated bits; called on clients
+	void ApplyAvailableBits(const TArray<uint32>& AvailableBits);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	// Spawned on every server, standalone included, when the world has sites; it also holds their bits there
+	virtual bool ShouldSpawnReplicator(const UWorld& InWorld) const override;
+
+private:
+
+	// Indexes the placed sites by path name, which is the same on the server and on clients
+	void EnsureSitesIndexed();
+
+	void CheckPlayers();
+	void TakePickup(int32 SiteIndex, APawn* Pawn);
+	void SetSiteAvailable(int32 SiteIndex, bool bAvailable);
+
+	TArray<TWeakObjectPtr<AGGPickupSite>> Sites;
+	TArray<FVector> SiteLocations;
+	TMap<uint64, TArray<int32, TInlineAllocator<4>>> SitesByCell;
+	bool bSitesIndexed = false;
+
+	// Respawn time and site index, as a min heap on time
+	TArray<TPair<double, int32>> RespawnQueue;
+
+	// Bits last applied on this client, so only the words that changed are visited
+	TArray<uint32> LastAppliedBits;
+
+	float CellSize = 1000.f;
+	double NextCheckTime = 0.0;
+};
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/SoftObjectPtr.h"
+
+#include "GGPreloadSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPreload, Log, All);
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FGGOnPreloadedPawnSpawned, APawn*, Pawn);
+
+struct FStreamableHandle;
+
+/**
+ * Loads pawn classes asynchronously together with everything they grant on spawn: the default
+ * abilities and effects of AGGCharacterBase. Each pawn class and its references form one group
+ * that stays loaded for the rest of the game.
+ *
+ * Preloads are started by the game mode during map load and can be requested again before a
+ * wave. SpawnPawnWhenReady defers a spawn until its group has loaded, so spawning never blocks
+ * the game thread. Anything that still had to be loaded synchronously is counted and reported by
+ * gg.Preload.Report.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static UGGPreloadSubsystem* Get(const UObject* WorldContextObject);
+
+	// Starts loading the pawn classes and their default abilities and effects
+	UFUNCTION(BlueprintCallable, Category = "Preload", meta = (WorldContext = "WorldContextObject"))
+	static void PreloadPawnClasses(const UObject* WorldContextObject, const TArray<TSoftClassPtr<APawn>>& PawnClasses);
+
+	// True once the pawn class and everything it grants on spawn are loaded
+	UFUNCTION(BlueprintPure, Category = "Preload", meta = (WorldContext = "WorldContextObject"))
+	static bool IsPawnClassReady(const UObject* WorldContextObject, const TSoftClassPtr<APawn>& PawnClass);
+
+	/**
+	 * Spawns the pawn as soon as its class is ready; right away if it already is.
+	 * The preload is started if nobody asked for it yet.
+	 * @param OnSpawned Called with the new pawn, or with nullptr if the class failed to load or spawn
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Preload", meta = (WorldContext = "WorldContextObject"))
+	static void SpawnPawnWhenReady(const UObject* WorldContextObject, TSoftClassPtr<APawn> PawnClass,
+								   const FTransform& SpawnTransform, FGGOnPreloadedPawnSpawned OnSpawned);
+
+	// Returns the class if it is loaded, otherwise loads it synchronously and reports the hitch
+	static UClass* GetOrLoadClass(const UObject* WorldContextObject, const FSoftObjectPath& ClassPath);
+
+	// Logs how long each preload took, and every synchronous load that was needed
+	void LogReport(FOutputDevice& Ar) const;
+
+	virtual void Deinitialize() override;
+
+private:
+
+	struct FPendingSpawn
+	{
+		TWeakObjectPtr<UWorld> World;
+		FTransform SpawnTransform;
+		FGGOnPreloadedPawnSpawned OnSpawned;
+	};
+
+	struct FPreloadGroup
+	{
+		TSharedPtr<FStreamableHandle> ClassHandle;
+		TSharedPtr<FStreamableHandle> DependencyHandle;
+		TArray<FPendingSpawn> PendingSpawns;
+
+		double RequestTime	   = 0.0;
+		double ClassLoadedTime = 0.0;
+		double ReadyTime	   = 0.0;
+		int32  NumDependencies = 0;
+		bool   bReady		   = false;
+	};
+
+	// Adds the group and starts loading its class, unless it was already requested
+	FPreloadGroup& RequestPreload(const FSoftObjectPath& ClassPath);
+
+	void OnClassLoaded(FSoftObjectPath ClassPath);
+	void OnDependenciesLoaded(FSoftObjectPath ClassPath);
+
+	void SpawnPending(const FSoftObjectPath& ClassPath, FPendingSpawn& PendingSpawn);
+
+	// Every requested pawn class and its dependencies
+	TMap<FSoftObjectPath, FPreloadGroup> Groups;
+
+	// Time of the first request since every group was last ready, for cold start timings
+	double FirstPendingRequestTime = 0.0;
+	int32  NumPendingGroups = 0;
+
+	int32  NumSyncLoads = 0;
+	double SyncLoadSeconds = 0.0;
+	TArray<FSoftObjectPath> SyncLoadedPaths;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GGGameplayAbility.h"
+
+#include "GGProjectileAbility.generated.h"
+
+class UGGProjectileAbilityData;
+
+/**
+ * Non-instanced projectile ability. Everything that differs between projectile types
+ * (projectile, damage effect, damage type, cost and cooldown) comes from a
+ * UGGProjectileAbilityData, so activating it never creates a UObject.
+ *
+ * The data is read from the spec's source object, falling back to DefaultProjectileData.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGProjectileAbility : public UGGGameplayAbility
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGProjectileAbility();
+
+	// Used when the ability was not granted with a UGGProjectileAbilityData source object
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Projectile")
+	TObjectPtr<UGGProjectileAbilityData> DefaultProjectileData;
+
+	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle,
+								 const FGameplayAbilityActorInfo* ActorInfo,
+								 const FGameplayAbilityActivationInfo ActivationInfo,
+								 const FGameplayEventData* TriggerEventData) override;
+
+	virtual bool CheckCost(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+						   FGameplayTagContainer* OptionalRelevantTags = nullptr) const override;
+
+	virtual void ApplyCost(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+						   const FGameplayAbilityActivationInfo ActivationInfo) const override;
+
+	virtual bool CheckCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+							   FGameplayTagContainer* OptionalRelevantTags = nullptr) const override;
+
+	virtual void ApplyCooldown(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+							   const FGameplayAbilityActivationInfo ActivationInfo) const override;
+
+protected:
+
+	// Finds the projectile data of the spec being activated
+	const UGGProjectileAbilityData* GetProjectileData(const FGameplayAbilitySpecHandle Handle,
+													  const FGameplayAbilityActorInfo* ActorInfo) const;
+
+	// Spawns the projectile on the server and hands it the damage spec
+	void SpawnProjectile(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo,
+						 const FGameplayAbilityActivationInfo ActivationInfo,
+						 const UGGProjectileAbilityData& ProjectileData) const;
+};
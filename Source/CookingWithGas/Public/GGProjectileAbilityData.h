@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GameplayTagContainer.h"
+#include "../CookingWithGas.h"
+
+#include "GGProjectileAbilityData.generated.h"
+
+class UGameplayEffect;
+class UGGProjectileAbility;
+
+/**
+ * Describes one projectile attack, such as acid, fire, chill or physical shots.
+ * Granted through AGGCharacterBase::DefaultProjectileAbilities; adding a new damage
+ * type only needs a new asset of this type.
+ */
+UCLASS(BlueprintType)
+class COOKINGWITHGAS_API UGGProjectileAbilityData : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGProjectileAbilityData();
+
+	// The ability granted for this asset; the asset is passed to it as the spec source object
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Ability")
+	TSubclassOf<UGGProjectileAbility> AbilityClass;
+
+	// The input the ability is bound to when granted
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Ability")
+	EAbilityInputID AbilityInputID = EAbilityInputID::Fire;
+
+	// The projectile spawned on activation; should implement IGGProjectileInterface
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Projectile")
+	TSubclassOf<AActor> ProjectileClass;
+
+	// Offset from the view point to the muzzle, along the view direction
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Projectile")
+	float MuzzleOffset = 100.f;
+
+	// Non-replicated projectile spawned by clients instead of replicating ProjectileClass; it should
+	// only play effects. If set, the server sends a shot event (see UGGShotEventSubsystem).
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Projectile")
+	TSubclassOf<AActor> CosmeticProjectileClass;
+
+	// The effect the projectile applies on hit
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Damage")
+	TSubclassOf<UGameplayEffect> DamageEffect;
+
+	// Damage passed to the effect through the Damage.SetByCaller magnitude
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Damage")
+	float Damage = 0.f;
+
+	// Damage type added to the damage spec, such as Damage.Type.Acid
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Damage", meta = (Categories = "Damage.Type"))
+	FGameplayTag DamageTypeTag;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Costs")
+	TSubclassOf<UGameplayEffect> CostEffect;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "Cooldowns")
+	TSubclassOf<UGameplayEffect> CooldownEffect;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+};
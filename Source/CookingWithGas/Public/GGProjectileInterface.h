@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffectTypes.h"
+#include "UObject/Interface.h"
+
+#include "GGProjectileInterface.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UGGProjectileInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Implemented by projectiles (such as BP_Projectile) that are spawned by native abilities.
+ * Called before the projectile finishes spawning.
+ */
+class COOKINGWITHGAS_API IGGProjectileInterface
+{
+	GENERATED_BODY()
+
+public:
+
+	// Hands the projectile the damage it applies to whatever it hits
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Projectile")
+	void InitializeProjectile(const FGameplayEffectSpecHandle& DamageSpec);
+
+	// Called on clients for cosmetic projectiles spawned from a shot event (see UGGShotEventSubsystem).
+	// The seed is the same on every client, for variations that should match between them.
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Projectile")
+	void InitializeCosmeticProjectile(int32 Seed);
+};
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "GGWorldReplicator.h"
+
+#include "GGShotEventSubsystem.generated.h"
+
+// One projectile fired on the server, as simulated by clients
+USTRUCT()
+struct COOKINGWITHGAS_API FGGShotEvent
+{
+	GENERATED_BODY()
+
+	// The cosmetic projectile clients spawn for the shot
+	UPROPERTY()
+	TSubclassOf<AActor> ProjectileClass;
+
+	UPROPERTY()
+	TWeakObjectPtr<AActor> Instigator;
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	// Sent as a half float; 0 keeps the cosmetic projectile's own initial speed
+	UPROPERTY()
+	float Speed = 0.f;
+
+	// Shared by every client, for cosmetic variations that should match between them
+	UPROPERTY()
+	uint16 Seed = 0;
+};
+
+// Every shot of one server frame, packed into a single RPC parameter
+USTRUCT()
+struct COOKINGWITHGAS_API FGGShotEventBatch
+{
+	GENERATED_BODY()
+
+	// Server world time the shots were fired at; shots of one frame share it
+	UPROPERTY()
+	float ServerTime = 0.f;
+
+	UPROPERTY()
+	TArray<FGGShotEvent> Events;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGGShotEventBatch> : public TStructOpsTypeTraitsBase2<FGGShotEventBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Always relevant actor spawned by UGGShotEventSubsystem on the server, used to send shot batches.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class COOKINGWITHGAS_API AGGShotEventReplicator : public AGGWorldReplicator
+{
+	GENERATED_BODY()
+
+public:
+
+	// Spawns the cosmetic projectiles on clients, moved forward by the time the batch took to arrive
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastShotEvents(const FGGShotEventBatch& Batch);
+
+private:
+
+	void SpawnCosmeticProjectile(const FGGShotEvent& Event, float FastForwardTime) const;
+};
+
+/**
+ * Replicates projectiles as shot events. Instead of every projectile being a replicated actor
+ * with its own channel and movement updates, the server keeps its projectile local and sends
+ * clients the shot (origin, direction, speed, projectile type and seed) in one unreliable
+ * multicast per frame. Clients spawn a non-replicated cosmetic projectile for it, so the cost
+ * of heavy fire no longer scales with the projectiles in flight.
+ *
+ * Hits stay server-authoritative: only the server's projectile applies damage, and clients learn
+ * about it through hit feedback and attribute replication.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGShotEventSubsystem : public UGGWorldReplicatorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGShotEventSubsystem();
+
+	/**
+	 * Stops replicating a projectile the server just spawned and queues its shot for clients.
+	 * Must be called in the frame the projectile was spawned, before it is replicated.
+	 * @param Projectile The server's projectile
+	 * @param CosmeticClass The projectile clients spawn instead; none keeps the projectile replicated
+	 * @return True if the projectile is sent as a shot event
+	 */
+	static bool ReplicateAsShotEvent(AActor* Projectile, TSubclassOf<AActor> CosmeticClass);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	TGGEventBatcher<FGGShotEventBatch> PendingEvents;
+};
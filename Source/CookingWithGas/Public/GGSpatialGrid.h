@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Cell math for the sparse 2D grids that match actors with what is near them, such as turrets
+ * with their candidates or pawns with pickup sites. Cells are squares of CellSize on the XY
+ * plane, and each is identified by one uint64 key, so a grid is a TMap from key to contents.
+ */
+namespace GGSpatialGrid
+{
+	// Key of the cell at the given cell coordinates
+	inline uint64 GetCellKey(int32 CellX, int32 CellY)
+	{
+		return (static_cast<uint64>(static_cast<uint32>(CellX)) << 32) | static_cast<uint32>(CellY);
+	}
+
+	// Key of the cell that contains the location
+	inline uint64 GetCellKey(const FVector& Location, float CellSize)
+	{
+		return GetCellKey(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+	}
+
+	// Calls Visit with the key of every cell that the square bounding the radius around the location touches
+	template <typename FunctorType>
+	void ForEachCellInRadius(const FVector& Location, float Radius, float CellSize, FunctorType&& Visit)
+	{
+		const int32 MinX = FMath::FloorToInt32((Location.X - Radius) / CellSize);
+		const int32 MaxX = FMath::FloorToInt32((Location.X + Radius) / CellSize);
+		const int32 MinY = FMath::FloorToInt32((Location.Y - Radius) / CellSize);
+		const int32 MaxY = FMath::FloorToInt32((Location.Y + Radius) / CellSize);
+		for (int32 CellX = MinX; CellX <= MaxX; ++CellX)
+		{
+			for (int32 CellY = MinY; CellY <= MaxY; ++CellY)
+			{
+				Visit(GetCellKey(CellX, CellY));
+			}
+		}
+	}
+}
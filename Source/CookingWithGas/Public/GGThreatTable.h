@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+/**
+ * Threat of each instigator against one actor, such as an enemy, for AI and turrets to pick
+ * who to go after. Entries are kept inline with a fixed capacity, so adding threat never
+ * allocates; when the table is full, the entry with the least threat is replaced.
+ *
+ * Threat decays exponentially with the half-life given to SetDecay. Every entry decays by the
+ * same factor, so decay never changes their order: threat is stored scaled up by the decay
+ * accumulated since a base time, and only the entry that just received threat can take the
+ * top spot. This keeps the top threat cached, so querying it is O(1).
+ */
+struct COOKINGWITHGAS_API FGGThreatTable
+{
+	static constexpr int32 Capacity = 8;
+
+	// Sets how threat decays; threat already in the table keeps its current value
+	void SetDecay(float InHalfLife, float InMinThreat, double Now);
+
+	// Adds threat for the instigator; ignored when the table is full of instigators with more threat
+	void AddThreat(AActor* Instigator, float Threat, double Now);
+
+	// Current threat of the instigator, 0 if it is not in the table
+	float GetThreat(const AActor* Instigator, double Now) const;
+
+	// The living instigator with the most threat, if it has at least MinThreat
+	AActor* GetTopThreat(double Now) const;
+
+	void Remove(const AActor* Instigator);
+	void Reset();
+
+private:
+
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Instigator;
+		// Threat scaled by the decay since BaseTime
+		float ScaledThreat = 0.f;
+	};
+
+	// Decay factor between BaseTime and the given time
+	float GetDecay(double Now) const;
+
+	// Moves BaseTime to now once the scale grows large, before it can lose precision
+	void Rebase(double Now);
+
+	// Finds the top entry again, skipping instigators that are gone or dead
+	void UpdateTopIndex() const;
+
+	static bool IsValidTarget(const AActor* Instigator);
+
+	TArray<FEntry, TInlineAllocator<Capacity>> Entries;
+	mutable int32 TopIndex = INDEX_NONE;
+
+	// Decay rate per second; 0 for no decay
+	float DecayRate = 0.f;
+	float MinThreat = 1.f;
+	double BaseTime = 0.0;
+};
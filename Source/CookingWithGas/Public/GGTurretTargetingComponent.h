@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+
+#include "GGTurretTargetingComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGGOnTurretTargetChanged,
+	AActor*, NewTarget, AActor*, OldTarget);
+
+/**
+ * Gives a turret its target through UGGTurretTargetingSubsystem instead of scanning on its own.
+ * Place it where the turret aims from; line of sight is traced from the component location.
+ *
+ * Targets are chosen on the server and replicated. Turrets are expected to stay in place;
+ * call RefreshRegistration after moving one or changing its range.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class COOKINGWITHGAS_API UGGTurretTargetingComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGGTurretTargetingComponent();
+
+	// Only actors of this class are targeted
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Targeting")
+	TSubclassOf<class AGGCharacterBase> TargetClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Targeting", meta = (ClampMin = "0"))
+	float Range = 2000.f;
+
+	// Targets hidden behind something blocking ECC_Visibility are skipped
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Targeting")
+	bool bRequireLineOfSight = true;
+
+	// Seconds between two evaluations of this turret's target while something is in range
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Targeting", meta = (ClampMin = "0"))
+	float ReevaluationInterval = 0.25f;
+
+	// The current target keeps priority until another candidate is this much closer, from 0 to 1
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Targeting", meta = (ClampMin = "0", ClampMax = "1"))
+	float TargetStickiness = 0.2f;
+
+	UPROPERTY(BlueprintAssignable, Category = "Targeting")
+	FGGOnTurretTargetChanged OnTargetChanged;
+
+	UFUNCTION(BlueprintPure, Category = "Targeting")
+	AActor* GetCurrentTarget() const { return CurrentTarget; }
+
+	// Registers again with the current location and range
+	UFUNCTION(BlueprintCallable, Category = "Targeting")
+	void RefreshRegistration();
+
+	// Called by UGGTurretTargetingSubsystem on the server
+	void SetCurrentTarget(AActor* NewTarget);
+
+	// Index in UGGTurretTargetingSubsystem, INDEX_NONE while unregistered
+	int32 TurretIndex = INDEX_NONE;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(ReplicatedUsing = OnRep_CurrentTarget)
+	TObjectPtr<AActor> CurrentTarget;
+
+	UFUNCTION()
+	void OnRep_CurrentTarget(AActor* OldTarget);
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GGTurretTargetingSubsystem.generated.h"
+
+class AGGCharacterBase;
+class UGGTurretTargetingComponent;
+
+/**
+ * Chooses targets for every UGGTurretTargetingComponent of the world, on the server.
+ *
+ * Every gg.TurretTargeting.CandidateInterval seconds the living characters are gathered once
+ * and binned into a 2D grid. Turrets register the grid cells their range covers, so only turrets
+ * sharing a cell with a candidate are woken up; the others cost nothing until something comes
+ * near. Awake turrets are re-evaluated round robin, within gg.TurretTargeting.BudgetMs and
+ * gg.TurretTargeting.MaxEvaluationsPerFrame, each at most once per ReevaluationInterval.
+ */
+UCLASS()
+class COOKINGWITHGAS_API UGGTurretTargetingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	void RegisterTurret(UGGTurretTargetingComponent* Turret);
+	void UnregisterTurret(UGGTurretTargetingComponent* Turret);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+
+	struct FTurret
+	{
+		TWeakObjectPtr<UGGTurretTargetingComponent> Component;
+		FVector Location = FVector::ZeroVector;
+		float	RangeSquared = 0.f;
+		TArray<uint64, TInlineAllocator<9>> Cells;
+		double	NextEvaluationTime = 0.0;
+		bool	bAwake = false;
+	};
+
+
+	// Gathers the candidates, bins them by cell, and wakes the turrets that share a cell with one
+	void RefreshCandidates(double Now);
+
+	// Picks the best target of one turret among the candidates of its cells
+	void EvaluateTurret(FTurret& Turret, double Now);
+
+	// Adds the turret to every cell its range touches, or removes it from them
+	void AddTurretToGrid(int32 TurretIndex);
+	void RemoveTurretFromGrid(int32 TurretIndex);
+
+	// Sparse so the index stored in each component stays valid
+	TSparseArray<FTurret> Turrets;
+
+	// Cell to the turrets whose range touches it; rebuilt only when turrets register
+	TMap<uint64, TArray<int32, TInlineAllocator<4>>> TurretsByCell;
+
+	TArray<TWeakObjectPtr<AGGCharacterBase>> Candidates;
+	TMap<uint64, TArray<int32, TInlineAllocator<4>>> CandidatesByCell;
+
+	// Turrets sharing a cell with a candidate, evaluated round robin starting at EvaluationCursor
+	TArray<int32> AwakeTurrets;
+	int32 EvaluationCursor = 0;
+
+	// Cell size the turret cells were computed with; a change rebuilds them
+	float GridCellSize = 0.f;
+
+	double NextCandidateRefreshTime = 0.0;
+};
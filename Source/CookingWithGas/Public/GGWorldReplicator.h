@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "GGWorldReplicator.generated.h"
+
+/**
+ * Always relevant actor spawned on the server by a UGGWorldReplicatorSubsystem, which replicates
+ * through it: multicasts of batched events, or properties shared by the whole world.
+ */
+UCLASS(Abstract, NotBlueprintable, NotPlaceable, Transient)
+class COOKINGWITHGAS_API AGGWorldReplicator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AGGWorldReplicator();
+};
+
+/**
+ * World subsystem that replicates through its own AGGWorldReplicator. The replicator of
+ * ReplicatorClass is spawned when the world begins play, so its channel is open on clients
+ * before anything is sent through it.
+ */
+UCLASS(Abstract)
+class COOKINGWITHGAS_API UGGWorldReplicatorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+protected:
+
+	// By default, only servers with clients spawn the replicator
+	virtual bool ShouldSpawnReplicator(const UWorld& InWorld) const;
+
+	// The replicator, if it was spawned; always of ReplicatorClass
+	template <typename ReplicatorType>
+	ReplicatorType* GetReplicator() const
+	{
+		return static_cast<ReplicatorType*>(Replicator.Get());
+	}
+
+	// Set by subclasses in their constructor
+	TSubclassOf<AGGWorldReplicator> ReplicatorClass;
+
+private:
+
+	UPROPERTY()
+	TObjectPtr<AGGWorldReplicator> Replicator;
+};
+
+/**
+ * Queue of the events a UGGWorldReplicatorSubsystem sends to clients once per frame, in
+ * multicasts of up to MaxEventsPerRPC events. BatchType is the net serialized RPC parameter;
+ * its Events array holds the events, and its other fields are shared by every event of a batch.
+ */
+template <typename BatchType>
+class TGGEventBatcher
+{
+public:
+
+	using EventType = typename decltype(BatchType::Events)::ElementType;
+
+	EventType& Add() { return PendingEvents.AddDefaulted_GetRef(); }
+	bool HasPendingEvents() const { return PendingEvents.Num() > 0; }
+	void Reset() { PendingEvents.Reset(); }
+
+	/**
+	 * Sends every queued event and empties the queue.
+	 * @param Batch The batch to send, with its shared fields already set
+	 * @param MaxEventsPerRPC Most events per batch; clamped to 1..255, since batches count their events in a byte
+	 * @param Send Called with each batch
+	 */
+	template <typename SendFunctorType>
+	void SendBatches(BatchType& Batch, int32 MaxEventsPerRPC, SendFunctorType&& Send)
+	{
+		const int32 BatchSize = FMath::Clamp(MaxEventsPerRPC, 1, 255);
+		for (int32 First = 0; First < PendingEvents.Num(); First += BatchSize)
+		{
+			const int32 Count = FMath::Min(BatchSize, PendingEvents.Num() - First);
+			Batch.Events.Reset();
+			Batch.Events.Append(PendingEvents.GetData() + First, Count);
+			Send(Batch);
+		}
+		PendingEvents.Reset();
+	}
+
+	/**
+	 * Writes or reads the events of a batch: their count, then each event behind a flags byte
+	 * that tells which of its optional fields follow.
+	 * @param Ar The archive
+	 * @param Events The events of the batch; resized when loading
+	 * @param GetFlags Returns the flags of an event being saved
+	 * @param SerializeEvent Writes or reads an event given its flags; returns false if part of it failed
+	 * @return False if any event failed
+	 */
+	template <typename GetFlagsType, typename SerializeEventType>
+	static bool NetSerializeEvents(FArchive& Ar, TArray<EventType>& Events, GetFlagsType&& GetFlags,
+		SerializeEventType&& SerializeEvent)
+	{
+		uint8 NumEvents = static_cast<uint8>(FMath::Min(Events.Num(), 255));
+		Ar << NumEvents;
+		if (Ar.IsLoading())
+		{
+			Events.SetNum(NumEvents);
+		}
+
+		bool bSuccess = true;
+		for (int32 i = 0; i < NumEvents; ++i)
+		{
+			EventType& Event = Events[i];
+
+			uint8 Flags = Ar.IsSaving() ? GetFlags(static_cast<const EventType&>(Event)) : 0;
+			Ar << Flags;
+			bSuccess &= SerializeEvent(Event, Flags);
+		}
+		return bSuccess;
+	}
+
+private:
+
+	TArray<EventType> PendingEvents;
+};